@@ -6,33 +6,124 @@ Features:
 */
 
 #include "include/ribbon.h"
+#include "include/traceGL.h"
 #include "include/win32tcp.h"
+#ifdef OS_LINUX
+#include "include/zenityFileDialog.h"
+#else
 #include "include/win32Tools.h"
+#endif
 #include "include/kissFFT.h"
+#include "include/spectrum.h"
+#include "include/spsc.h"
+#include "include/channel.h"
+#include "include/trigger.h"
+#include "include/harmonic.h"
+#include "include/pointgrid.h"
 #include <time.h>
+#include <float.h>
+#include <ctype.h>
+#ifdef OS_LINUX
+#include <sys/stat.h>
+#else
 #include <direct.h>
+#endif
 #include <pthread.h>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#ifdef OS_LINUX
+/* linux stand-ins for the win32Tools cursor, clipboard, and file dialog functions */
+#define CURSOR_POINTER              GLFW_ARROW_CURSOR
+#define CURSOR_UPDOWN               GLFW_VRESIZE_CURSOR
+#define CURSOR_SIDESIDE             GLFW_HRESIZE_CURSOR
+#define CURSOR_DIAGONALLEFT         GLFW_CROSSHAIR_CURSOR // glfw 3.3 has no diagonal resize cursors
+#define CURSOR_DIAGONALRIGHT        GLFW_CROSSHAIR_CURSOR
+#define win32FileDialog             zenityFileDialog
+#define win32FileDialogAddExtension zenityFileDialogAddExtension
+#define win32FileDialogPrompt       zenityFileDialogPrompt
+#define _mkdir(path)                mkdir(path, 0777)
+
+typedef struct {
+    const char *text; // clipboard text data (owned by glfw)
+} win32ClipboardObject;
+
+win32ClipboardObject win32Clipboard;
+
+/* unlike win32 SetCursor, a glfw cursor stays until it is changed, so it is set back to CURSOR_POINTER every frame nothing is being resized (see renderOrder) */
+void win32SetCursor(int shape) {
+    static GLFWcursor *cursors[GLFW_VRESIZE_CURSOR - GLFW_ARROW_CURSOR + 1];
+    static int current = GLFW_ARROW_CURSOR;
+    if (shape == current) {
+        return;
+    }
+    int cursorIndex = shape - GLFW_ARROW_CURSOR;
+    if (cursors[cursorIndex] == NULL) {
+        cursors[cursorIndex] = glfwCreateStandardCursor(shape);
+    }
+    glfwSetCursor(turtle.window, cursors[cursorIndex]);
+    current = shape;
+}
+
+int win32ClipboardSetText(const char *input) {
+    glfwSetClipboardString(turtle.window, input);
+    return 0;
+}
+
+int win32ClipboardGetText() {
+    win32Clipboard.text = glfwGetClipboardString(turtle.window);
+    if (win32Clipboard.text == NULL) {
+        win32Clipboard.text = "";
+        return -1;
+    }
+    return 0;
+}
+#endif
 
 // #define DEBUGGING_FLAG // enable logging debugging (terminal)
 
 #define TCP_RECEIVE_BUFFER_LENGTH        2048
 #define MAX_SIMULTANEOUS_LOGGING_SOCKETS 4   // see https://docs.amdc.dev/getting-started/user-guide/logging/streaming.html#performance
+#define AMDC_PACKET_LENGTH               20  // HEADER, VAR_SLOT, TS, DATA, FOOTER (32 bits each)
+#define AMDC_PACKET_HEADER_BYTE          0x11
+#define AMDC_PACKET_FOOTER_BYTE          0x22
+#define SAMPLE_QUEUE_LENGTH              262144 // samples buffered per variable between the comms thread and the render thread
+#define COMMS_POLL_TIMEOUT               50  // milliseconds the comms thread waits for socket readiness before checking threadCloseSignal
+#define AMDC_TIMESTAMP_SECONDS           0.000001 // one tick of the AMDC packet timestamp
+#define MIN_RETENTION_SAMPLES            4096 // smallest ring buffer any channel gets, regardless of retention settings
 
 #define DIAL_LINEAR       0
 #define DIAL_LOG          1
 #define DIAL_EXP          2
 
 /* there is little reason for why these window IDs were set as powers of two, but it would be difficult to change now */
-#define NUM_WINDOWS       10
+#define NUM_WINDOWS       12
 #define WINDOW_INFO       1
 #define WINDOW_FREQ       2
 #define WINDOW_EDITOR     4
 #define WINDOW_ORBIT      8
 #define WINDOW_OSC        32
+#define WINDOW_SPECTROGRAM 512 // after the four oscilloscopes
+#define WINDOW_HARMONIC   1024
+#define WINDOW_BODE       2048
 
-#define TRIGGER_TIMEOUT   150
+#define TRIGGER_TIMEOUT   1250000 // default microseconds of data without a trigger before the oscilloscope free-runs
 #define PHASE_THRESHOLD   0.5
+#define FREQ_MAX_SEGMENTS 32 // most averaged segments handed to the FFT workers at once, older ones are skipped if they fall behind
+#define FREQ_CHANNELS 4 // channels of one oscilloscope the frequency view can overlay
+#define FREQ_WORKERS 4 // FFT worker threads, each transforms one channel of a request at a time
+#define SPECTROGRAM_HISTORY 512 // columns across the spectrogram
+#define HARMONIC_TREND 256 // rows of amplitude history in the harmonic trend lines, one per frame with new samples
+#define HARMONIC_MAX_WINDOW 262144 // longest harmonic tracker window (samples)
+#define SPECTROGRAM_MAX_COLUMNS 16 // most spectrogram columns transformed per frame, older ones are skipped if it falls behind
+#define BODE_MAX_SEGMENTS 8 // most Bode segments transformed per frame, older ones are skipped if it falls behind
 #define ORBIT_DIST_THRESH 2500
+#define ORBIT_MERGE_LENGTH 131072 // merged orbit points kept, must be more than the Samples dial can ask for (TRACEGL_MIRROR_LENGTH)
+#define ORBIT_GRID_CELLS 32 // hover grid cells across the orbit view on each axis
+#define ORBIT_TURTLE_LENGTH 500 // most orbit points drawn per frame without traceGL
 
 #define NUMBER_OF_OSC     4
 #define NUMBER_OF_ORBIT   2
@@ -47,10 +138,49 @@ void delay_ms(int delay) {
     }
 }
 
-enum trigger_type {
-    TRIGGER_NONE = 0,
-    TRIGGER_RISING_EDGE,
-    TRIGGER_FALLING_EDGE
+enum trigger_logic {
+    TRIGGER_LOGIC_OFF = 0, // first condition only
+    TRIGGER_LOGIC_AND, // first condition, only while the second one's qualifier holds
+    TRIGGER_LOGIC_OR // either condition
+};
+
+enum osc_mode {
+    OSC_MODE_AUTO = 0, // live view, free-runs when the trigger times out
+    OSC_MODE_NORMAL, // every trigger freezes a new capture
+    OSC_MODE_SINGLE // one capture, then wait to be armed again
+};
+
+enum freq_length {
+    FREQ_LENGTH_FAST = 0, // osc window zero padded to the next length with factors of 2, 3 and 5
+    FREQ_LENGTH_POW2, // osc window zero padded to the next power of two
+    FREQ_LENGTH_FIXED // fixed N ending at the osc window's right bound, the rest of the options index freqFixedLengths
+};
+
+const int freqFixedLengths[] = {1024, 4096, 16384, 65536};
+
+const int spectrogramSizes[] = {256, 512, 1024, 2048, 4096};
+const int spectrogramHops[] = {8, 4, 2, 1}; // hop is the FFT size divided by this
+const int bodeSizes[] = {1024, 2048, 4096, 8192, 16384};
+
+enum spectrogram_colormap {
+    SPECTROGRAM_VIRIDIS = 0,
+    SPECTROGRAM_INFERNO,
+    SPECTROGRAM_GRAY,
+    SPECTROGRAM_JET
+};
+
+enum harmonic_reference {
+    HARMONIC_FIXED = 0, // fundamental set by the dial
+    HARMONIC_SPEED, // electrical frequency (Hz) from a logged variable
+    HARMONIC_ANGLE // electrical angle (radians) from a logged variable
+};
+
+const unsigned char harmonicColors[] = {230, 80, 60, 240, 160, 40, 200, 200, 50, 90, 190, 80, 50, 170, 200, 80, 110, 230, 170, 90, 220, 220, 110, 170}; // trend line colours, repeat after eight harmonics
+
+enum freq_average {
+    FREQ_AVERAGE_OFF = 0, // one transform of the osc window
+    FREQ_AVERAGE_LINEAR, // Welch, mean of the next Averages segments of the live channel, then hold until reset
+    FREQ_AVERAGE_EXPONENTIAL // Welch, running average with weight 1 / Averages
 };
 
 typedef struct { // dial
@@ -128,11 +258,27 @@ typedef struct { // general window attributes
 } window_t;
 
 typedef struct {
-    double threshold;
-    int type;
-    int index;
-    int timeout;
-    list_t *lastIndex;
+    int64_t index; // first sample past the threshold (in the selected channel)
+    double fraction; // where between sample index - 1 and index the threshold was crossed
+    double time; // time (seconds) of the crossing
+    int dataIndex; // channel the crossing was found in
+} trigger_point_t;
+
+typedef struct {
+    double threshold[2]; // level of each condition
+    int type[2]; // enum trigger_type of each condition
+    int source[2]; // channel each condition looks at - 0 follows the selected channel, otherwise an index in self.data
+    double level2[2]; // second level of each condition's window, runt and slope band
+    double widthMinMicroseconds[2]; // pulse width and slope time limits of each condition (0 maximum means no upper limit)
+    double widthMaxMicroseconds[2];
+    int logic; // enum trigger_logic
+    double holdoffMicroseconds; // crossings this soon after the last trigger are ignored
+    double timeoutMicroseconds; // free-run after this long without a trigger
+    trigger_point_t pending; // accepted crossing waiting for its post-trigger samples (index 0 if none)
+    trigger_point_t point; // published trigger point (index 0 if not triggered)
+    double time; // time (seconds) of the last accepted crossing, for holdoff
+    trigger_t engine[2]; // events found for each condition
+    channel_t *engineChannel[2]; // channel each engine is scanning
 } trigger_settings_t;
 
 typedef struct { // oscilloscope view
@@ -140,8 +286,8 @@ typedef struct { // oscilloscope view
     int dataIndex[4]; // index of data list for oscilloscope source (up to four channels)
     int oldSelectedChannel; // keep track of selected channel last tick
     int selectedChannel; // selected channel (1-4) of oscilloscope
-    int leftBound[4]; // left bound (index in data list) - local per channel
-    int rightBound[4]; // right bound (index in data list) - local per channel
+    int64_t leftBound[4]; // left bound (absolute sample index in channel) - local per channel
+    int64_t rightBound[4]; // right bound (absolute sample index in channel) - local per channel
     double bottomBound[4]; // bottom bound (y value) - local per channel
     double topBound[4]; // top bound (y value) - local per channel
     double dummyTopBound; // dummy top bound for manipulation via dial
@@ -149,7 +295,15 @@ typedef struct { // oscilloscope view
     double windowSizeMicroseconds; // size of window (in microseconds) - global per oscilloscope
     int windowSizeSamples[4]; // size of window (in samples) - local per channel
     int stop; // pause and unpause - global per oscilloscope
-    int above; // whether the current data point is above or below the trigger point
+    double phase[4]; // fraction of a sample that the trigger point lies past each channel's sample before it, traces are shifted left by it
+    int mode; // OSC_MODE_AUTO, OSC_MODE_NORMAL or OSC_MODE_SINGLE
+    double preTrigger; // percent of the window before the trigger point
+    int armed; // single mode only captures when armed
+    int arm; // arm button
+    int captured; // capture holds a frozen trigger
+    channel_t *capture[4]; // samples around the last trigger at their live absolute indices, kept while the live channels move on
+    traceGLMirror *captureMirror[4]; // GPU copy of each capture
+    double capturePhase[4]; // phase of each capture
 } oscilloscope_t;
 
 typedef struct { // orbit view
@@ -157,31 +311,184 @@ typedef struct { // orbit view
     double scale[2];
     double offset[2];
     double samples;
-    int stopIndex[2]; // index of most recent orbit sample
+    int64_t stopIndex; // absolute index of most recent merged orbit point
     int dataIndex[2]; // index of data list for orbit source (X, Y)
+    channel_t *merged[2]; // X and Y sources merged by timestamp, a point has the same absolute index in both
+    channel_t *mergedSource[2]; // source channels the merge was built from (rebuilt when these change)
+    int64_t mergeCursor[2]; // next sample of each source not yet merged
     int plotIndex[2]; // index inside data list for orbit plot (X, Y)
+    pointgrid_t grid; // merged points the trail shows, for the mouse readout
+    traceGLPair *mirror; // GPU copy of merged, NULL until traceGL first draws it
 } orbit_t;
 
+typedef struct { // reassembles AMDC packets across recv() boundaries
+    uint8_t buffer[AMDC_PACKET_LENGTH + TCP_RECEIVE_BUFFER_LENGTH]; // bytes carried over from the last read followed by the new read
+    int carry; // number of bytes at the start of buffer left over from the last read
+    uint64_t packetsDecoded; // total good packets
+    uint64_t packetsRecovered; // good packets that were split across two reads
+    uint64_t bytesSkipped; // bytes discarded while resynchronising to a header
+} amdcFramer_t;
+
 typedef struct {
     char name[128]; // name of variable
     int slot; // Slot # within AMDC (e.g. Slot 0: LOG_amdc_channel_1), -1 when not in use
+    double samplesPerSecond; // nominal sample rate from log info, samples live in self.data
     SOCKET *socketPtr; // pointer to SOCKET used to stream data for this variable, NULL when not in use
     int socketID; // ID of socket on AMDC (AMDC gives us this when the socket is created), -1 when not in use
-    pthread_t thread; // data logging thread for this variable, -1 when not in use
+    amdcFramer_t framer; // packet reassembly state for this variable's stream
+    spsc_t *queue; // samples decoded by the comms thread waiting to be moved into self.data by the render thread, NULL until a socket is opened
 } logVariable_t;
 
+typedef struct { // one channel of a frequency view request
+    spectrum_buffer_t samples; // raw samples (float)
+    int length; // samples in the segment, or in the block when averaging (0 if the channel completed no new segment)
+    int channel; // osc channel, picks the trace colour
+    double samplesPerSecond;
+} freq_input_t;
+
+typedef struct { // segments under the frequency view, copied on the render thread and transformed on the FFT workers
+    freq_input_t input[FREQ_CHANNELS]; // [0] is the selected channel, the others follow in overlay mode
+    int inputs;
+    int fftLength; // segment length padded up to the transform length, the same for every input so they share a plan and window
+    int hop; // samples between averaged segments of fftLength in the block, 0 for one segment of length samples
+    int window; // spectrum_window
+    int average; // freq_average
+    int averages;
+    int reset; // restart the averages with this block
+} freq_request_t;
+
+typedef struct { // one transformed channel
+    spectrum_buffer_t magnitude; // bins floats
+    spectrum_buffer_t phase;
+    int bins; // fftLength / 2 + 1, 0 until the channel has been transformed
+    int fftLength; // samples transformed
+    int channel; // osc channel
+    double samplesPerSecond;
+} freq_spectrum_t;
+
+typedef struct { // every channel of one request
+    freq_spectrum_t spectrum[FREQ_CHANNELS];
+    int count;
+} freq_spectra_t;
+
+typedef struct { // running average of one input, only touched by the FFT worker transforming that input
+    spectrum_buffer_t segment; // windowed and zero padded transform input, SPECTRUM_LANES segments at a time
+    spectrum_buffer_t bins;
+    spectrum_buffer_t work; // half length scratch for the real transform
+    spectrum_buffer_t lanePower; // bin power of each lane of the last transform
+    spectrum_buffer_t power; // running average of bin power (float)
+    int powerBins;
+    int segments; // segments in the running average
+} freq_accumulator_t;
+
+typedef struct { // spectrogram view, a sliding short-time FFT of one logged variable
+    int dataIndex; // logged variable
+    int sizeIndex; // FFT size (spectrogramSizes)
+    int hopIndex; // hop as a fraction of the FFT size (spectrogramHops)
+    int window; // spectrum_window
+    int colormap; // spectrogram_colormap
+    double top; // dB at the top of the colormap
+    double range; // dB spanned by the colormap
+    channel_t *channel; // channel, size, hop and window the running STFT was started with
+    int size;
+    int hop;
+    int windowType;
+    int appliedColormap; // colormap uploaded to the image
+    double samplesPerSecond;
+    int64_t next; // first sample of the next column
+    int64_t columns; // columns since the STFT was restarted
+    spectrum_buffer_t coefficients; // window
+    double windowSum;
+    spectrum_buffer_t block; // raw samples under the columns transformed this frame (float)
+    spectrum_buffer_t segment; // windowed samples, SPECTRUM_LANES columns at a time
+    spectrum_buffer_t bins;
+    spectrum_buffer_t work; // half length scratch for the real transform
+    spectrum_buffer_t power; // bin power of each lane of the last transform
+    spectrum_buffer_t pending; // columns transformed this frame, uploaded together
+    spectrum_buffer_t history; // CPU copy of the image in dB (SPECTROGRAM_HISTORY columns), for the mouse readout and the turtle fallback
+    traceGLImage *image; // GPU copy, NULL without traceGL
+} spectrogram_t;
+
+typedef struct { // one tracked channel of the harmonic view
+    channel_t *channel; // live channel the tracker was started on, NULL if there is no tracker
+    harmonic_t tracker;
+    int64_t next; // next sample of channel to push
+    double phase; // fundamental phase at the last pushed sample (speed and angle references)
+    int64_t referenceIndex; // last reference sample folded into phase, -1 to start from the next one
+    double angle; // last angle read, for unwrapping
+} harmonic_channel_t;
+
+typedef struct { // harmonic view, the first few harmonics of every channel of an oscilloscope
+    harmonic_channel_t channel[4];
+    int oscIndex;
+    int trendChannel; // osc channel drawn in the trend lines
+    int reference; // harmonic_reference
+    int referenceIndex; // logged variable the speed or angle comes from
+    double fundamental; // Hz, the fixed fundamental and the starting guess for the other references
+    double harmonicsDial;
+    double cycles; // fundamental cycles in a tracker window
+    int harmonics; // settings the trackers were started with
+    int appliedReference;
+    int appliedReferenceIndex;
+    int appliedOsc;
+    float trend[HARMONIC_TREND][HARMONIC_MAX]; // amplitudes of the trend channel, a ring starting trendLength rows before trendHead
+    int trendHead;
+    int trendLength;
+} harmonic_view_t;
+
+typedef struct { // Bode view, transfer function from one logged variable to another out of averaged cross spectra
+    int inputIndex; // logged variables
+    int outputIndex;
+    int sizeIndex; // FFT size (bodeSizes)
+    int window; // spectrum_window
+    double overlap; // percent of a segment shared with the next
+    double averages; // segments in the average
+    int reset; // restart the average
+    double top; // dB at the top of the magnitude plot
+    double range; // dB spanned by the magnitude plot
+    channel_t *input; // channels, size, hop, window and averages the running average was started with
+    channel_t *output;
+    int size;
+    int hop;
+    int windowType;
+    int appliedAverages;
+    double samplesPerSecond;
+    int rateMismatch; // input and output are logged at different rates, nothing is estimated
+    int64_t next; // first input sample of the next segment
+    int64_t offset; // output index minus input index of the same moment
+    int64_t segments; // segments since the average was restarted
+    spectrum_plan_t *plan; // held for size
+    spectrum_buffer_t coefficients; // window
+    double windowSum;
+    spectrum_buffer_t samples; // raw input then output samples of one segment (float)
+    spectrum_buffer_t segment; // windowed samples, input and output in separate lanes when there are lanes
+    spectrum_buffer_t bins;
+    spectrum_buffer_t work; // half length scratch for the real transform
+    spectrum_buffer_t transforms; // input then output bins of the last segment (float real, imaginary)
+    spectrum_buffer_t inputPower; // averaged |X|^2, |Y|^2 and conj(X) Y (double)
+    spectrum_buffer_t outputPower;
+    spectrum_buffer_t cross;
+} bode_t;
+
 typedef struct { // all the empv shared state is here
     /* comms */
     int tcpInit;
     int threadCloseSignal;
+    pthread_t commsThread; // single thread that services every logging socket
+    char commsThreadRunning;
     char commsEnabled;
     SOCKET *cmdSocket;
     int cmdSocketID;
     uint8_t tcpAsciiReceiveBuffer[TCP_RECEIVE_BUFFER_LENGTH];
     int maxSlots; // maximum logging slots on AMDC
     /* general */
-        list_t *data; // a list of lists of all data collected through ethernet (first element is samples/s)
+        list_t *data; // a list of channel_t of all data collected through ethernet
+        list_t *traceMirrors; // GPU copies of self.data for traceGL (traceGLMirror, NULL until a channel is first drawn)
+        double retentionSeconds; // how much history each channel keeps
+        double appliedRetentionSeconds; // retentionSeconds that the channels are currently sized for
+        int64_t retentionSamples; // if positive, overrides retentionSeconds with a fixed sample count
         list_t *logVariables; // a list of variables logged on the AMDC (logVariable_t)
+        list_t *triggerSources; // "Selected" followed by the names of self.logVariables, options of the trigger source dropdowns
         list_t *usedVariableIndices;
         list_t *oldUsedVariableIndices;
         list_t *windowRender; // which order to render windows in (uses pow2 addressing)
@@ -206,15 +513,60 @@ typedef struct { // all the empv shared state is here
         oscilloscope_t osc[NUMBER_OF_OSC]; // up to four oscilloscopes
         int newOsc;
     /* frequency view */
-        list_t *windowData; // segment of normal data through windowing function
-        list_t *freqData; // frequency data
-        list_t *phaseData; // phase data
+        pthread_t freqThread[FREQ_WORKERS]; // FFT workers, so large windows do not hold up the render thread and overlaid channels are transformed side by side
+        int freqThreads; // workers running
+        pthread_mutex_t freqLock; // guards the hand-off flags, job counters and swaps below, never held during a transform
+        pthread_cond_t freqSignal;
+        int freqThreadClose;
+        freq_request_t freqRequest[3]; // [0] filled by the render thread, [1] waiting for the workers, [2] being transformed
+        int freqRequestWaiting; // freqRequest[1] holds segments the workers have not taken
+        int freqBusy; // freqRequest[2] has jobs that are not finished
+        int freqJobs; // jobs of freqRequest[2] (freqJobCount), 0 until its window and plan are ready
+        int freqJobNext; // next job of freqRequest[2] for a worker to take
+        int freqJobsLeft; // jobs of freqRequest[2] not finished
+        spectrum_plan_t *freqPlan; // plan shared by the inputs of freqRequest[2]
+        freq_spectra_t freqSpectra[2]; // [0] drawn by the render thread, [1] written by the workers
+        int freqSpectrumReady; // freqSpectra[1] is finished and the render thread has not taken it
+        channel_t *freqChannel[FREQ_CHANNELS]; // sources and bounds of the last segments handed over, unchanged segments are not transformed again
+        int64_t freqLeft[FREQ_CHANNELS];
+        int64_t freqRight[FREQ_CHANNELS];
+        int freqSubmittedInputs;
+        int freqSubmittedLength; // fftLength of the last segments handed over
+        int freqSubmittedWindow;
+        int freqRevision; // bumped when channel contents change under the same bounds (captures, reconnecting)
+        int freqSubmittedRevision;
+        channel_t *welchChannel[FREQ_CHANNELS]; // live channels and settings the running averages were started with
+        int welchInputs; // 0 restarts the averages
+        int welchLength;
+        int welchWindow;
+        int welchAverage;
+        int welchAverages;
+        int welchReset; // the next block restarts the averages
+        int64_t welchNext[FREQ_CHANNELS]; // first sample of the next averaged segment of each channel
+        spectrum_buffer_t freqWindow; // window coefficients, rebuilt when the type or length changes (FFT workers only)
+        int freqWindowType;
+        int freqWindowLength;
+        double freqWindowSum;
+        freq_accumulator_t freqAccumulator[FREQ_CHANNELS]; // per input state of the FFT workers, a single shot job uses the buffers of its first input
         int freqOscIndex; // referenced oscilloscope
         int freqOscChannel; // referenced channel
+        int freqAllChannels; // overlay every channel of the oscilloscope
+        int freqLengthMode; // how the FFT length is chosen (freq_length)
+        int freqWindowMode; // spectrum_window
+        int freqAverageMode; // freq_average
+        double freqOverlap; // percent overlap of averaged segments
+        double freqAverages; // segments in a linear average, time constant in segments of an exponential one
+        int freqReset; // restart the average
         int freqLeftBound;
         int freqRightBound;
         double freqZoom;
         double topFreq; // top bound (y value)
+    /* spectrogram view */
+        spectrogram_t spectrogram;
+    /* harmonic view */
+        harmonic_view_t harmonic;
+    /* bode view */
+        bode_t bode;
     /* orbit view */
         orbit_t orbit[NUMBER_OF_ORBIT]; // up to two orbit plots
         int newOrbit;
@@ -315,7 +667,97 @@ button_t *buttonInit(char *label, int *variable, int window, double xOffset, dou
     return button;
 }
 
-logVariable_t *variableInit(char *name, int slot, SOCKET *socketPtr, int socketID, pthread_t thread) {
+void amdcFramerReset(amdcFramer_t *framer) {
+    framer -> carry = 0;
+    framer -> packetsDecoded = 0;
+    framer -> packetsRecovered = 0;
+    framer -> bytesSkipped = 0;
+}
+
+/* returns the index of the first 0x11111111 header in buffer[start, end), or end if there is none */
+int amdcFindHeader(uint8_t *buffer, int start, int end) {
+    int i = start;
+    /* a header starts at i + k if bytes i + k through i + k + 3 all match, so AND four shifted compares together */
+    #if defined(__AVX2__)
+    __m256i headerByte256 = _mm256_set1_epi8(AMDC_PACKET_HEADER_BYTE);
+    while (i + 35 <= end) {
+        __m256i match = _mm256_cmpeq_epi8(_mm256_loadu_si256((__m256i *) (buffer + i)), headerByte256);
+        match = _mm256_and_si256(match, _mm256_cmpeq_epi8(_mm256_loadu_si256((__m256i *) (buffer + i + 1)), headerByte256));
+        match = _mm256_and_si256(match, _mm256_cmpeq_epi8(_mm256_loadu_si256((__m256i *) (buffer + i + 2)), headerByte256));
+        match = _mm256_and_si256(match, _mm256_cmpeq_epi8(_mm256_loadu_si256((__m256i *) (buffer + i + 3)), headerByte256));
+        unsigned int mask = (unsigned int) _mm256_movemask_epi8(match);
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+        i += 32;
+    }
+    #endif
+    #if defined(__SSE2__)
+    __m128i headerByte128 = _mm_set1_epi8(AMDC_PACKET_HEADER_BYTE);
+    while (i + 19 <= end) {
+        __m128i match = _mm_cmpeq_epi8(_mm_loadu_si128((__m128i *) (buffer + i)), headerByte128);
+        match = _mm_and_si128(match, _mm_cmpeq_epi8(_mm_loadu_si128((__m128i *) (buffer + i + 1)), headerByte128));
+        match = _mm_and_si128(match, _mm_cmpeq_epi8(_mm_loadu_si128((__m128i *) (buffer + i + 2)), headerByte128));
+        match = _mm_and_si128(match, _mm_cmpeq_epi8(_mm_loadu_si128((__m128i *) (buffer + i + 3)), headerByte128));
+        unsigned int mask = (unsigned int) _mm_movemask_epi8(match);
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+        i += 16;
+    }
+    #endif
+    while (i + 4 <= end) {
+        if (buffer[i] == AMDC_PACKET_HEADER_BYTE && buffer[i + 1] == AMDC_PACKET_HEADER_BYTE && buffer[i + 2] == AMDC_PACKET_HEADER_BYTE && buffer[i + 3] == AMDC_PACKET_HEADER_BYTE) {
+            return i;
+        }
+        i++;
+    }
+    return end;
+}
+
+uint32_t amdcReadWord(uint8_t *bytes) {
+    return ((uint32_t) bytes[3]) << 24 | ((uint32_t) bytes[2]) << 16 | ((uint32_t) bytes[1]) << 8 | ((uint32_t) bytes[0]);
+}
+
+/*
+decodes every complete packet in framer -> buffer[0, length) into values (at most length / AMDC_PACKET_LENGTH of them) and returns how many were decoded
+the first framer -> carry bytes are left over from the previous read, any trailing partial packet is moved to the front of the buffer for the next read
+*/
+int amdcFramerDecode(amdcFramer_t *framer, int length, spsc_sample_t *samples) {
+    uint8_t *buffer = framer -> buffer;
+    int numValues = 0;
+    int index = 0;
+    while (length - index >= AMDC_PACKET_LENGTH) {
+        if (amdcReadWord(buffer + index) == 0x11111111 && amdcReadWord(buffer + index + 16) == 0x22222222) {
+            uint32_t data = amdcReadWord(buffer + index + 12);
+            memcpy(&samples[numValues].value, &data, sizeof(float));
+            samples[numValues].timestamp = amdcReadWord(buffer + index + 8);
+            numValues++;
+            if (index < framer -> carry) {
+                framer -> packetsRecovered++;
+            }
+            index += AMDC_PACKET_LENGTH;
+            continue;
+        }
+        /* lost sync, skip to the next header */
+        int next = amdcFindHeader(buffer, index + 1, length);
+        if (next == length) {
+            /* keep the last 3 bytes in case they are the start of a header */
+            next = length - 3;
+        }
+        #ifdef DEBUGGING_FLAG
+        printf("bad packet, skipped %d bytes\n", next - index);
+        #endif
+        framer -> bytesSkipped += next - index;
+        index = next;
+    }
+    framer -> packetsDecoded += numValues;
+    framer -> carry = length - index;
+    memmove(buffer, buffer + index, framer -> carry);
+    return numValues;
+}
+
+logVariable_t *variableInit(char *name, int slot, double samplesPerSecond, SOCKET *socketPtr, int socketID) {
     logVariable_t *variable = malloc(sizeof(logVariable_t));
     if (name == NULL) {
         memcpy(variable -> name, "", strlen("") + 1);
@@ -323,9 +765,11 @@ logVariable_t *variableInit(char *name, int slot, SOCKET *socketPtr, int socketI
         memcpy(variable -> name, name, strlen(name) + 1);
     }
     variable -> slot = slot;
+    variable -> samplesPerSecond = samplesPerSecond;
     variable -> socketPtr = socketPtr;
     variable -> socketID = socketID;
-    variable -> thread = thread;
+    amdcFramerReset(&variable -> framer);
+    variable -> queue = NULL;
     return variable;
 }
 
@@ -356,30 +800,197 @@ double angleBetween(double x1, double y1, double x2, double y2) {
     return output;
 }
 
-void fft_list_wrapper(list_t *samples, list_t *frequencyOutput, list_t *phaseOutput) {
-    int dimension = samples -> length;
-    if (dimension <= 0) {
-        return;
+/* window and plan shared by every input of freqRequest[2], set up once by the FFT worker that takes the request */
+void freqPrepare(freq_request_t *request) {
+    int segmentLength = request -> hop > 0 ? request -> fftLength : request -> input[0].length;
+    if (request -> window != self.freqWindowType || segmentLength != self.freqWindowLength) {
+        self.freqWindowSum = spectrum_window(spectrum_reserve(&self.freqWindow, sizeof(float) * segmentLength), segmentLength, request -> window);
+        self.freqWindowType = request -> window;
+        self.freqWindowLength = segmentLength;
+    }
+    self.freqPlan = spectrum_plan(request -> fftLength);
+}
+
+/* jobs a request is split into - every averaged input is a job whose segments fill the lanes of each transform
+single shot inputs have one segment each, so SPECTRUM_LANES of them share a job and a transform */
+int freqJobCount(freq_request_t *request) {
+    if (request -> hop > 0) {
+        return request -> inputs;
+    }
+    return (request -> inputs + SPECTRUM_LANES - 1) / SPECTRUM_LANES;
+}
+
+/* window and transform the segments of one job, fold them into the averages of its inputs and write their spectra, runs on an FFT worker
+a single shot input is one segment of length samples, an averaged one is every hop of fftLength samples in the block */
+void freqTransform(freq_request_t *request, int job, freq_spectra_t *spectra) {
+    int fftLength = request -> fftLength;
+    int segmentLength = self.freqWindowLength;
+    int bins = fftLength / 2 + 1;
+    int first = job;
+    int inputs = 1;
+    if (request -> hop == 0) {
+        first = job * SPECTRUM_LANES;
+        inputs = request -> inputs - first < SPECTRUM_LANES ? request -> inputs - first : SPECTRUM_LANES;
+    }
+    freq_accumulator_t *scratch = &self.freqAccumulator[first];
+    kiss_fft_scalar *segment = spectrum_reserve(&scratch -> segment, sizeof(kiss_fft_scalar) * fftLength);
+    kiss_fft_cpx *transform = spectrum_reserve(&scratch -> bins, sizeof(kiss_fft_cpx) * bins);
+    kiss_fft_cpx *work = spectrum_reserve(&scratch -> work, sizeof(kiss_fft_cpx) * (fftLength / 2));
+    float *lanePower = spectrum_reserve(&scratch -> lanePower, sizeof(float) * bins * SPECTRUM_LANES);
+    float *window = self.freqWindow.data;
+    const float *signals[SPECTRUM_LANES] = {NULL};
+    int phaseLane[SPECTRUM_LANES]; // lane of transform holding the newest segment of each input, -1 if it was not transformed
+    for (int k = 0; k < inputs; k++) {
+        freq_accumulator_t *accumulator = &self.freqAccumulator[first + k];
+        spectrum_reserve(&accumulator -> power, sizeof(float) * bins);
+        if (request -> reset || request -> hop == 0 || accumulator -> powerBins != bins) {
+            float *power = accumulator -> power.data;
+            for (int i = 0; i < bins; i++) {
+                power[i] = 0;
+            }
+            accumulator -> powerBins = bins;
+            accumulator -> segments = 0;
+        }
+        phaseLane[k] = -1;
+    }
+    if (request -> hop == 0) {
+        /* one segment of each input, side by side in the lanes */
+        for (int k = 0; k < inputs; k++) {
+            signals[k] = request -> input[first + k].samples.data;
+        }
+        spectrum_load(segment, signals, inputs, window, segmentLength, fftLength);
+        spectrum_rfft(self.freqPlan, segment, transform, work);
+        spectrum_power(lanePower, transform, bins);
+        for (int k = 0; k < inputs; k++) {
+            freq_accumulator_t *accumulator = &self.freqAccumulator[first + k];
+            spectrum_average(accumulator -> power.data, lanePower, bins, k, 1);
+            accumulator -> segments = 1;
+            phaseLane[k] = k;
+        }
+    } else {
+        /* consecutive segments of the input, SPECTRUM_LANES per transform */
+        freq_accumulator_t *accumulator = scratch;
+        freq_input_t *input = &request -> input[first];
+        float *samples = input -> samples.data;
+        int segments = input -> length >= segmentLength ? (input -> length - segmentLength) / request -> hop + 1 : 0;
+        if (request -> average == FREQ_AVERAGE_LINEAR && segments > request -> averages - accumulator -> segments) {
+            segments = request -> averages - accumulator -> segments; // linear average is complete, it holds until it is reset
+        }
+        for (int start = 0; start < segments; start += SPECTRUM_LANES) {
+            int lanes = segments - start < SPECTRUM_LANES ? segments - start : SPECTRUM_LANES;
+            for (int k = 0; k < lanes; k++) {
+                signals[k] = samples + (int64_t) (start + k) * request -> hop;
+            }
+            spectrum_load(segment, signals, lanes, window, segmentLength, fftLength);
+            spectrum_rfft(self.freqPlan, segment, transform, work);
+            spectrum_power(lanePower, transform, bins);
+            for (int k = 0; k < lanes; k++) {
+                /* equal weights until the average is full, then exponential averaging keeps a fixed weight */
+                float weight = 1.0 / (accumulator -> segments + 1);
+                if (accumulator -> segments >= request -> averages) {
+                    weight = 1.0 / request -> averages;
+                }
+                spectrum_average(accumulator -> power.data, lanePower, bins, k, weight);
+                accumulator -> segments++;
+            }
+            phaseLane[0] = lanes - 1;
+        }
+    }
+    for (int k = 0; k < inputs; k++) {
+        freq_accumulator_t *accumulator = &self.freqAccumulator[first + k];
+        freq_spectrum_t *spectrum = &spectra -> spectrum[first + k];
+        spectrum -> bins = 0;
+        if (accumulator -> segments > 0) {
+            /* parse */
+            float *magnitude = spectrum_reserve(&spectrum -> magnitude, sizeof(float) * bins);
+            float *phase = spectrum_reserve(&spectrum -> phase, sizeof(float) * bins);
+            spectrum_magnitude(magnitude, accumulator -> power.data, bins, fftLength, self.freqWindowSum);
+            for (int i = 0; i < bins; i++) {
+                phase[i] = 0;
+                /* https://www.gaussianwaves.com/2015/11/interpreting-fft-results-obtaining-magnitude-and-phase-information/ */
+                if (phaseLane[k] >= 0 && magnitude[i] > PHASE_THRESHOLD) {
+                    phase[i] = atan2(spectrum_lane(transform[i].i, phaseLane[k]), spectrum_lane(transform[i].r, phaseLane[k])); // phase of the newest segment
+                }
+            }
+            spectrum -> bins = bins;
+        }
+        spectrum -> fftLength = fftLength;
+        spectrum -> channel = request -> input[first + k].channel;
+        spectrum -> samplesPerSecond = request -> input[first + k].samplesPerSecond;
+    }
+}
+
+/* every worker runs this - an idle worker takes a waiting request and sets up its window and plan, then all of them take its jobs one at a time
+the worker that finishes the last job publishes the spectra */
+void *freqThreadFunction(void *arg) {
+    pthread_mutex_lock(&self.freqLock);
+    while (1) {
+        /* wait for a job of the current request, or for a new request once the render thread has taken the last spectra so the back buffer is free */
+        while (self.freqThreadClose == 0 && self.freqJobNext >= self.freqJobs && (self.freqBusy || self.freqRequestWaiting == 0 || self.freqSpectrumReady)) {
+            pthread_cond_wait(&self.freqSignal, &self.freqLock);
+        }
+        if (self.freqThreadClose) {
+            break;
+        }
+        if (self.freqJobNext >= self.freqJobs) {
+            freq_request_t request = self.freqRequest[1];
+            self.freqRequest[1] = self.freqRequest[2];
+            self.freqRequest[2] = request;
+            self.freqRequestWaiting = 0;
+            self.freqBusy = 1;
+            pthread_mutex_unlock(&self.freqLock);
+            freqPrepare(&self.freqRequest[2]);
+            pthread_mutex_lock(&self.freqLock);
+            self.freqJobNext = 0;
+            self.freqJobs = freqJobCount(&self.freqRequest[2]);
+            self.freqJobsLeft = self.freqJobs;
+            pthread_cond_broadcast(&self.freqSignal);
+            continue;
+        }
+        int index = self.freqJobNext++;
+        pthread_mutex_unlock(&self.freqLock);
+        freqTransform(&self.freqRequest[2], index, &self.freqSpectra[1]);
+        pthread_mutex_lock(&self.freqLock);
+        self.freqJobsLeft--;
+        if (self.freqJobsLeft == 0) {
+            spectrum_plan_release(self.freqPlan);
+            self.freqSpectra[1].count = self.freqRequest[2].inputs;
+            self.freqJobNext = 0;
+            self.freqJobs = 0;
+            self.freqBusy = 0;
+            self.freqSpectrumReady = 1;
+        }
     }
-    kiss_fft_cfg cfg = kiss_fft_alloc(dimension, 0, NULL, NULL);
-    /* convert to complex */
-    kiss_fft_cpx complexSamples[dimension];
-    for (int i = 0; i < dimension; i++) {
-        complexSamples[i].r = samples -> data[i].d;
-        complexSamples[i].i = 0.0f;
+    pthread_mutex_unlock(&self.freqLock);
+    return NULL;
+}
+
+void freqThreadStart() {
+    pthread_mutex_init(&self.freqLock, NULL);
+    pthread_cond_init(&self.freqSignal, NULL);
+    self.freqThreadClose = 0;
+    self.freqBusy = 0;
+    self.freqJobNext = 0;
+    self.freqJobs = 0;
+    self.freqJobsLeft = 0;
+    self.freqThreads = 0;
+    for (int i = 0; i < FREQ_WORKERS; i++) {
+        if (pthread_create(&self.freqThread[self.freqThreads], NULL, freqThreadFunction, NULL) == 0) {
+            self.freqThreads++;
+        }
     }
-    kiss_fft(cfg, complexSamples, complexSamples);
-    kiss_fft_free(cfg);
-    /* parse */
-    for (int i = 0; i < dimension; i++) {
-        double fftSample = sqrt(complexSamples[i].r * complexSamples[i].r + complexSamples[i].i * complexSamples[i].i) / self.osc[self.freqOscIndex].windowSizeSamples[self.freqOscChannel]; // divide by closest rounded down power of 2 instead of window size
-        list_append(frequencyOutput, (unitype) (fftSample * 2.356), 'd');
-        double fftPhase = 0.0;
-        /* https://www.gaussianwaves.com/2015/11/interpreting-fft-results-obtaining-magnitude-and-phase-information/ */
-        if (fftSample > PHASE_THRESHOLD) {
-            fftPhase = atan2(complexSamples[i].i, complexSamples[i].r);
+}
+
+void freqThreadStop() {
+    if (self.freqThreads > 0) {
+        pthread_mutex_lock(&self.freqLock);
+        self.freqThreadClose = 1;
+        pthread_cond_broadcast(&self.freqSignal);
+        pthread_mutex_unlock(&self.freqLock);
+        for (int i = 0; i < self.freqThreads; i++) {
+            pthread_join(self.freqThread[i], NULL);
         }
-        list_append(phaseOutput, (unitype) fftPhase, 'd');
+        self.freqThreads = 0;
     }
 }
 
@@ -413,7 +1024,8 @@ void commsCommand(char *cmd) {
     win32tcpReceive2(self.cmdSocket, self.tcpAsciiReceiveBuffer, TCP_RECEIVE_BUFFER_LENGTH);
 }
 
-void commsGetData(int logSlotIndex) {
+/* read whatever is buffered on a logging socket and parse it, returns the result of the recv (0 when the AMDC closed the socket) */
+int commsGetData(int logSlotIndex) {
     /*
     Per the AMDC C-code,
 
@@ -425,61 +1037,84 @@ void commsGetData(int logSlotIndex) {
     HEADER = 0x11111111
     FOOTER = 0x22222222
     */
-    uint32_t header = 0x11111111;
-    uint32_t footer = 0x22222222;
-    int packetLength = 20;
-    uint8_t tcpLoggingReceiveBuffer[TCP_RECEIVE_BUFFER_LENGTH] = {0};
-    int dataIndex = ((logVariable_t *) self.logVariables -> data[logSlotIndex].p) -> slot + 1;
-    win32tcpReceive2(((logVariable_t *) self.logVariables -> data[logSlotIndex].p) -> socketPtr, tcpLoggingReceiveBuffer, TCP_RECEIVE_BUFFER_LENGTH);
-    int index = 0;
-    while (tcpLoggingReceiveBuffer[index] == 0x11 && tcpLoggingReceiveBuffer[index + 1] == 0x11 && tcpLoggingReceiveBuffer[index + 2] == 0x11 && tcpLoggingReceiveBuffer[index + 3] == 0x11) {
-        index += 4;
-        uint32_t varSlot = ((uint32_t) tcpLoggingReceiveBuffer[index + 3]) << 24 | ((uint32_t) tcpLoggingReceiveBuffer[index + 2]) << 16 | ((uint32_t) tcpLoggingReceiveBuffer[index + 1]) << 8 | ((uint32_t) tcpLoggingReceiveBuffer[index + 0]);
-        index += 4;
-        uint32_t timestamp = ((uint32_t) tcpLoggingReceiveBuffer[index + 3]) << 24 | ((uint32_t) tcpLoggingReceiveBuffer[index + 2]) << 16 | ((uint32_t) tcpLoggingReceiveBuffer[index + 1]) << 8 | ((uint32_t) tcpLoggingReceiveBuffer[index + 0]);
-        index += 4;
-        uint32_t data = ((uint32_t) tcpLoggingReceiveBuffer[index + 3]) << 24 | ((uint32_t) tcpLoggingReceiveBuffer[index + 2]) << 16 | ((uint32_t) tcpLoggingReceiveBuffer[index + 1]) << 8 | ((uint32_t) tcpLoggingReceiveBuffer[index + 0]);
-        index += 4;
-        if (tcpLoggingReceiveBuffer[index] == 0x22 && tcpLoggingReceiveBuffer[index + 1] == 0x22 && tcpLoggingReceiveBuffer[index + 2] == 0x22 && tcpLoggingReceiveBuffer[index + 3] == 0x22) {
-            /* add value to data */
-            float dataValue = *(float *) &data;
-            list_append(self.data -> data[dataIndex].r, (unitype) (double) dataValue, 'd');
-            index += 4;
-        } else {
-            printf("bad packet at index %d\n", index);
-            index += 4;
-        }
+    logVariable_t *variable = self.logVariables -> data[logSlotIndex].p;
+    int received = win32tcpReceiveNonBlocking(variable -> socketPtr, variable -> framer.buffer + variable -> framer.carry, TCP_RECEIVE_BUFFER_LENGTH);
+    if (received <= 0) {
+        return received;
     }
+    spsc_sample_t samples[(AMDC_PACKET_LENGTH + TCP_RECEIVE_BUFFER_LENGTH) / AMDC_PACKET_LENGTH];
+    int numValues = amdcFramerDecode(&variable -> framer, variable -> framer.carry + received, samples);
+    /* publish the batch, the render thread moves it into self.data (see commsDrainQueues) */
+    spsc_push(variable -> queue, samples, numValues);
+    return received;
 }
 
+/* one thread waits on every logging socket and parses whichever are readable, so CPU use follows the data rate instead of the number of sockets */
 void *commsThreadFunction(void *arg) {
-    int index = *(int *) arg;
-    int *socketID = &(((logVariable_t *) self.logVariables -> data[index].p) -> socketID);
-    printf("started thread with index %d and socketID %d\n", index, *socketID);
-    int loopstep = 0;
-    clock_t start;
-    clock_t cycle;
-    start = clock();
-    cycle = clock();
-    /* populate real data */
-    while (1) {
-        start = clock();
-        if (self.commsEnabled == 1) {
-            if (*socketID != -1) {
-                commsGetData(index);
+    SOCKET *readySockets[MAX_SIMULTANEOUS_LOGGING_SOCKETS];
+    #ifdef DEBUGGING_FLAG
+    printf("started comms thread\n");
+    #endif
+    while (self.threadCloseSignal == 0) {
+        int ready = win32tcpPoll(readySockets, MAX_SIMULTANEOUS_LOGGING_SOCKETS, COMMS_POLL_TIMEOUT);
+        for (int i = 0; i < ready; i++) {
+            /* find which logged variable this socket belongs to */
+            for (int j = 1; j < self.logVariables -> length; j++) {
+                logVariable_t *variable = self.logVariables -> data[j].p;
+                if (variable -> socketPtr == readySockets[i] && variable -> socketID != -1) {
+                    if (commsGetData(j) == 0) {
+                        /* AMDC closed this socket, stop waiting on it */
+                        win32tcpUnwatchSocket(readySockets[i]);
+                    }
+                    break;
+                }
             }
         }
-        if (self.threadCloseSignal) {
-            return NULL;
+    }
+    return NULL;
+}
+
+/* called once per frame on the render thread - moves everything the comms thread has published into self.data */
+void commsDrainQueues() {
+    spsc_sample_t samples[4096];
+    for (int i = 1; i < self.logVariables -> length; i++) {
+        logVariable_t *variable = self.logVariables -> data[i].p;
+        if (variable -> queue == NULL) {
+            continue;
         }
-        loopstep++;
-        if ((clock() - cycle) / CLOCKS_PER_SEC > 3) {
-            printf("thread index %d is running at %lf loops per second\n", index, loopstep / 3);
-            loopstep = 0;
-            cycle = clock();
+        int dataIndex = variable -> slot + 1;
+        channel_t *channel = self.data -> data[dataIndex].p;
+        int numValues = spsc_pop(variable -> queue, samples, 4096);
+        while (numValues > 0) {
+            for (int j = 0; j < numValues; j++) {
+                /* the AMDC timestamp is 32 bits, unwrap it against the previous one */
+                int64_t time = samples[j].timestamp;
+                if (channel -> length > 0) {
+                    time = channel -> lastTime + (int32_t) (samples[j].timestamp - (uint32_t) channel -> lastTime);
+                }
+                channel_append_timed(channel, samples[j].value, time);
+            }
+            numValues = spsc_pop(variable -> queue, samples, 4096);
         }
     }
-    return NULL;
+}
+
+void commsThreadStart() {
+    if (self.commsEnabled == 0 || self.commsThreadRunning) {
+        return;
+    }
+    self.threadCloseSignal = 0;
+    if (pthread_create(&self.commsThread, NULL, commsThreadFunction, NULL) == 0) {
+        self.commsThreadRunning = 1;
+    }
+}
+
+void commsThreadStop() {
+    self.threadCloseSignal = 1;
+    if (self.commsThreadRunning) {
+        pthread_join(self.commsThread, NULL);
+        self.commsThreadRunning = 0;
+    }
 }
 
 void *specialInitThread(void *arg) {
@@ -511,6 +1146,18 @@ void gatherUsedSockets() {
             }
         }
     }
+    if (list_count(self.usedVariableIndices, (unitype) self.spectrogram.dataIndex, 'i') == 0) {
+        list_append(self.usedVariableIndices, (unitype) self.spectrogram.dataIndex, 'i');
+    }
+    if (self.harmonic.reference != HARMONIC_FIXED && list_count(self.usedVariableIndices, (unitype) self.harmonic.referenceIndex, 'i') == 0) {
+        list_append(self.usedVariableIndices, (unitype) self.harmonic.referenceIndex, 'i');
+    }
+    if (list_count(self.usedVariableIndices, (unitype) self.bode.inputIndex, 'i') == 0) {
+        list_append(self.usedVariableIndices, (unitype) self.bode.inputIndex, 'i');
+    }
+    if (list_count(self.usedVariableIndices, (unitype) self.bode.outputIndex, 'i') == 0) {
+        list_append(self.usedVariableIndices, (unitype) self.bode.outputIndex, 'i');
+    }
     int indexOfZero = list_find(self.usedVariableIndices, (unitype) 0, 'i');
     while (indexOfZero != -1) {
         list_delete(self.usedVariableIndices, indexOfZero);
@@ -548,6 +1195,11 @@ void populateUsedSockets() {
     #endif
 
     if (self.commsEnabled == 1) {
+        /* the comms thread reads socketPtr and socketID and polls the watched sockets, so it is stopped while they change */
+        char commsWasRunning = self.commsThreadRunning;
+        if (toAdd -> length > 0 || toRemove -> length > 0) {
+            commsThreadStop();
+        }
         /* open a new logging socket for each used logged variable */
         for (int i = 1; i < self.logVariables -> length; i++) {
             if (list_count(toAdd, (unitype) i, 'i') > 0) {
@@ -561,23 +1213,24 @@ void populateUsedSockets() {
                     int sID = *receiveBuffer;
                     ((logVariable_t *) self.logVariables -> data[i].p) -> socketPtr = sptr;
                     ((logVariable_t *) self.logVariables -> data[i].p) -> socketID = sID;
+                    amdcFramerReset(&((logVariable_t *) self.logVariables -> data[i].p) -> framer);
+                    if (((logVariable_t *) self.logVariables -> data[i].p) -> queue == NULL) {
+                        ((logVariable_t *) self.logVariables -> data[i].p) -> queue = spsc_init(SAMPLE_QUEUE_LENGTH);
+                    }
+                    win32tcpWatchSocket(sptr); // only once the framer and queue are ready
                 }
             }
             if (list_count(toRemove, (unitype) i, 'i') > 0) {
                 int savedSocketID = ((logVariable_t *) self.logVariables -> data[i].p) -> socketID;
                 ((logVariable_t *) self.logVariables -> data[i].p) -> socketID = -1;
-                delay_ms(10); // allow thread function to exit
+                win32tcpUnwatchSocket(((logVariable_t *) self.logVariables -> data[i].p) -> socketPtr);
                 closesocket(*(((logVariable_t *) self.logVariables -> data[i].p) -> socketPtr));
                 ((logVariable_t *) self.logVariables -> data[i].p) -> socketPtr = NULL;
                 printf("Successfully closed AMDC log socket with id %d\n", savedSocketID);
             }    
         }
-        int threadArg[self.logVariables -> length];
-        for (int i = 1; i < self.logVariables -> length; i++) {
-            if (list_count(toAdd, (unitype) i, 'i') > 0) {
-                threadArg[i] = i;
-                pthread_create(&((logVariable_t *) self.logVariables -> data[i].p) -> thread, NULL, commsThreadFunction, &threadArg[i]);
-            }
+        if (commsWasRunning) {
+            commsThreadStart();
         }
         /* clear all streams - FIXME */
         // for (int i = 0; i < self.maxSlots; i++) {
@@ -603,37 +1256,141 @@ void populateUsedSockets() {
     list_copy(self.usedVariableIndices, self.oldUsedVariableIndices);
 }
 
+int64_t retentionCapacity(double samplesPerSecond) { // number of samples a channel at this rate keeps
+    int64_t capacity = self.retentionSamples;
+    if (capacity <= 0) {
+        capacity = self.retentionSeconds * samplesPerSecond;
+    }
+    if (capacity < MIN_RETENTION_SAMPLES) {
+        capacity = MIN_RETENTION_SAMPLES;
+    }
+    return capacity;
+}
+
+void applyRetention() { // resize every channel after the retention setting changed
+    for (int i = 1; i < self.data -> length; i++) {
+        channel_t *channel = self.data -> data[i].p;
+        channel_resize(channel, retentionCapacity(((logVariable_t *) self.logVariables -> data[i].p) -> samplesPerSecond));
+    }
+    self.appliedRetentionSeconds = self.retentionSeconds;
+}
+
+/* time of a sample in seconds - from the AMDC timestamps when the channel has them, otherwise from the nominal sample rate */
+double sampleTime(int dataIndex, int64_t index) {
+    channel_t *channel = self.data -> data[dataIndex].p;
+    if (channel -> anchorLength > 0) {
+        return channel_time(channel, index) * AMDC_TIMESTAMP_SECONDS;
+    }
+    return index / ((logVariable_t *) self.logVariables -> data[dataIndex].p) -> samplesPerSecond;
+}
+
+/* fractional absolute index of a channel at a time in seconds, inverse of sampleTime */
+double sampleIndexAtTime(int dataIndex, double time) {
+    channel_t *channel = self.data -> data[dataIndex].p;
+    if (channel -> anchorLength > 0) {
+        return channel_index_at(channel, time / AMDC_TIMESTAMP_SECONDS);
+    }
+    return time * ((logVariable_t *) self.logVariables -> data[dataIndex].p) -> samplesPerSecond;
+}
+
+/* GPU mirror of a channel, made the first time the channel is drawn */
+traceGLMirror *channelMirror(int dataIndex) {
+    while (self.traceMirrors -> length < self.data -> length) {
+        list_append(self.traceMirrors, (unitype) NULL, 'p');
+    }
+    if (self.traceMirrors -> data[dataIndex].p == NULL) {
+        self.traceMirrors -> data[dataIndex].p = traceGLMirrorInit();
+    }
+    return self.traceMirrors -> data[dataIndex].p;
+}
+
+void loadConfig(char *filename) {
+    FILE *fp = fopen(filename, "r");
+    if (fp == NULL) {
+        return; // keep defaults
+    }
+    char line[256];
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        char key[128];
+        double value;
+        if (line[0] == '#' || sscanf(line, "%127s %lf", key, &value) != 2) {
+            continue;
+        }
+        if (strcmp(key, "retention_seconds") == 0 && value > 0) {
+            self.retentionSeconds = value;
+        } else if (strcmp(key, "retention_samples") == 0) {
+            self.retentionSamples = value;
+        }
+    }
+    fclose(fp);
+}
+
+void populateTriggerSources() {
+    list_clear(self.triggerSources);
+    list_append(self.triggerSources, (unitype) "Selected", 's');
+    for (int i = 1; i < self.logVariables -> length; i++) {
+        list_append(self.triggerSources, (unitype) ((logVariable_t *) self.logVariables -> data[i].p) -> name, 's');
+    }
+}
+
 void populateLoggedVariables() {
-    self.threadCloseSignal = 1; // destroy all existing threads
-    delay_ms(100);
+    commsThreadStop(); // comms thread must not touch the lists while they are rebuilt
+    for (int i = 0; i < self.logVariables -> length; i++) {
+        logVariable_t *variable = self.logVariables -> data[i].p;
+        if (variable -> queue != NULL) {
+            spsc_free(variable -> queue);
+            variable -> queue = NULL;
+        }
+    }
+    for (int i = 0; i < self.data -> length; i++) {
+        channel_free(self.data -> data[i].p);
+    }
     list_clear(self.data);
-    list_append(self.data, (unitype) list_init(), 'r'); // unused list
-    list_append(self.data -> data[0].r, (unitype) 120.0, 'd'); // dummy 120 samples/s
+    for (int i = 0; i < self.newOsc; i++) {
+        self.osc[i].trigger.engineChannel[0] = NULL; // new channels may reuse the old addresses
+        self.osc[i].trigger.engineChannel[1] = NULL;
+        self.osc[i].captured = 0;
+    }
+    self.freqRevision++;
+    self.welchInputs = 0; // new channels may reuse the old addresses
+    self.spectrogram.channel = NULL;
+    self.bode.input = NULL;
+    self.bode.output = NULL;
+    for (int i = 0; i < 4; i++) {
+        if (self.harmonic.channel[i].channel != NULL) {
+            harmonic_free(&self.harmonic.channel[i].tracker);
+            self.harmonic.channel[i].channel = NULL;
+        }
+    }
+    for (int i = 0; i < self.traceMirrors -> length; i++) {
+        if (self.traceMirrors -> data[i].p != NULL) {
+            traceGLMirrorFree(self.traceMirrors -> data[i].p);
+        }
+    }
+    list_clear(self.traceMirrors);
+    list_append(self.data, (unitype) (void *) channel_init(1), 'p'); // unused channel
 
     list_clear(self.logVariables);
-    logVariable_t *dummyVariable = variableInit("Unused", -1, NULL, -1, -1);
+    logVariable_t *dummyVariable = variableInit("Unused", -1, 120.0, NULL, -1);
     list_append(self.logVariables, (unitype) (void *) dummyVariable, 'p');
     if (self.commsEnabled == 0) {
         /* make demo slots */
-        logVariable_t *demoVariable1 = variableInit("Demo1", -1, NULL, -1, -1);
+        logVariable_t *demoVariable1 = variableInit("Demo1", -1, 120.0, NULL, -1);
         list_append(self.logVariables, (unitype) (void *) demoVariable1, 'p');
-        list_append(self.data, (unitype) list_init(), 'r');
-        list_append(self.data -> data[self.data -> length - 1].r, (unitype) 120.0, 'd'); // set samples/s
+        list_append(self.data, (unitype) (void *) channel_init(retentionCapacity(120.0)), 'p');
 
-        logVariable_t *demoVariable2 = variableInit("Demo2", -1, NULL, -1, -1);
+        logVariable_t *demoVariable2 = variableInit("Demo2", -1, 240.0, NULL, -1);
         list_append(self.logVariables, (unitype) (void *) demoVariable2, 'p');
-        list_append(self.data, (unitype) list_init(), 'r');
-        list_append(self.data -> data[self.data -> length - 1].r, (unitype) 240.0, 'd'); // set samples/s
+        list_append(self.data, (unitype) (void *) channel_init(retentionCapacity(240.0)), 'p');
 
-        logVariable_t *demoVariable3 = variableInit("Demo3", -1, NULL, -1, -1);
+        logVariable_t *demoVariable3 = variableInit("Demo3", -1, 120.0, NULL, -1);
         list_append(self.logVariables, (unitype) (void *) demoVariable3, 'p');
-        list_append(self.data, (unitype) list_init(), 'r');
-        list_append(self.data -> data[self.data -> length - 1].r, (unitype) 120.0, 'd'); // set samples/s
+        list_append(self.data, (unitype) (void *) channel_init(retentionCapacity(120.0)), 'p');
 
-        logVariable_t *demoVariable4 = variableInit("Demo4", -1, NULL, -1, -1);
+        logVariable_t *demoVariable4 = variableInit("Demo4", -1, 120.0, NULL, -1);
         list_append(self.logVariables, (unitype) (void *) demoVariable4, 'p');
-        list_append(self.data, (unitype) list_init(), 'r');
-        list_append(self.data -> data[self.data -> length - 1].r, (unitype) 120.0, 'd'); // set samples/s
+        list_append(self.data, (unitype) (void *) channel_init(retentionCapacity(120.0)), 'p');
+        populateTriggerSources();
         return;
     }
     commsCommand("log info");
@@ -656,13 +1413,12 @@ void populateLoggedVariables() {
                         break;
                     }
                 }
-                logVariable_t *newVariable = variableInit(testString + 8, slotNum, NULL, -1, -1);
+                logVariable_t *newVariable = variableInit(testString + 8, slotNum, 0, NULL, -1);
                 list_append(self.logVariables, (unitype) (void *) newVariable, 'p');
-                list_append(self.data, (unitype) list_init(), 'r');
+                list_append(self.data, (unitype) (void *) channel_init(retentionCapacity(0)), 'p'); // resized once the sampling interval is known
                 #ifdef DEBUGGING_FLAG
                 printf("identified logging variable: %s\n", testString + 8);
                 #endif
-                // list_append(self.data -> data[self.data -> length - 1].r, (unitype) 120.0, 'd'); // set samples/s
                 break;
             case 4: // Type: <type>
                 break;
@@ -671,7 +1427,8 @@ void populateLoggedVariables() {
             case 2: // Sampling interval (usec): <usec>
                 double samplingInterval = 0.0; // in microseconds
                 sscanf(testString + 28, "%lf", &samplingInterval);
-                list_append(self.data -> data[self.data -> length - 1].r, (unitype) (1 / (samplingInterval / 1000000)), 'd'); // set samples/s
+                ((logVariable_t *) self.logVariables -> data[self.logVariables -> length - 1].p) -> samplesPerSecond = 1 / (samplingInterval / 1000000); // set samples/s
+                channel_resize(self.data -> data[self.data -> length - 1].p, retentionCapacity(((logVariable_t *) self.logVariables -> data[self.logVariables -> length - 1].p) -> samplesPerSecond));
                 break;
             case 1: // Num samples: <num>
                 break;
@@ -697,19 +1454,31 @@ void populateLoggedVariables() {
     #ifdef DEBUGGING_FLAG
     printf("Max Logging Slots: %d\n", self.maxSlots);
     #endif
-    self.threadCloseSignal = 0; // enable threads
+    populateTriggerSources();
     /* populate sockets */
     populateUsedSockets();
+    commsThreadStart();
 }
 
 void createNewOsc() {
     if (self.newOsc > NUMBER_OF_OSC - 1) {
         return;
     }
-    self.osc[self.newOsc].trigger.threshold = 0.0;
-    self.osc[self.newOsc].trigger.type = TRIGGER_NONE;
-    self.osc[self.newOsc].trigger.index = 0;
-    self.osc[self.newOsc].trigger.lastIndex = list_init();
+    for (int i = 0; i < 2; i++) {
+        self.osc[self.newOsc].trigger.threshold[i] = 0.0;
+        self.osc[self.newOsc].trigger.type[i] = TRIGGER_NONE;
+        self.osc[self.newOsc].trigger.source[i] = 0;
+        self.osc[self.newOsc].trigger.engineChannel[i] = NULL;
+        self.osc[self.newOsc].trigger.level2[i] = 10.0;
+        self.osc[self.newOsc].trigger.widthMinMicroseconds[i] = 0;
+        self.osc[self.newOsc].trigger.widthMaxMicroseconds[i] = 0;
+    }
+    self.osc[self.newOsc].trigger.logic = TRIGGER_LOGIC_OFF;
+    self.osc[self.newOsc].trigger.pending.index = 0;
+    self.osc[self.newOsc].trigger.point.index = 0;
+    self.osc[self.newOsc].trigger.time = -DBL_MAX;
+    self.osc[self.newOsc].trigger.holdoffMicroseconds = 0;
+    self.osc[self.newOsc].trigger.timeoutMicroseconds = TRIGGER_TIMEOUT;
     if (self.logVariables -> length > 1) {
         self.osc[self.newOsc].dataIndex[0] = 1; // Demo 1
     } else {
@@ -721,8 +1490,8 @@ void createNewOsc() {
     self.osc[self.newOsc].selectedChannel = 0;
     self.osc[self.newOsc].oldSelectedChannel = 0;
     for (int i = 0; i < 4; i++) {
-        self.osc[self.newOsc].leftBound[i] = 1;
-        self.osc[self.newOsc].rightBound[i] = 1;
+        self.osc[self.newOsc].leftBound[i] = 0;
+        self.osc[self.newOsc].rightBound[i] = 0;
         self.osc[self.newOsc].bottomBound[i] = -100;
         self.osc[self.newOsc].topBound[i] = 100;
     }
@@ -730,7 +1499,17 @@ void createNewOsc() {
     self.osc[self.newOsc].dummyOffset = 0;
     self.osc[self.newOsc].windowSizeMicroseconds = 1000000;
     self.osc[self.newOsc].stop = 0;
-    self.osc[self.newOsc].above = 0;
+    self.osc[self.newOsc].mode = OSC_MODE_AUTO;
+    self.osc[self.newOsc].preTrigger = 50;
+    self.osc[self.newOsc].armed = 1;
+    self.osc[self.newOsc].arm = 0;
+    self.osc[self.newOsc].captured = 0;
+    for (int i = 0; i < 4; i++) {
+        self.osc[self.newOsc].phase[i] = 0;
+        self.osc[self.newOsc].capture[i] = channel_init(1);
+        self.osc[self.newOsc].captureMirror[i] = NULL;
+        self.osc[self.newOsc].capturePhase[i] = 0;
+    }
     int oscIndex = ilog2(WINDOW_OSC) + self.newOsc;
     sprintf(self.windows[oscIndex].title, "Oscilloscope %d", self.newOsc + 1);
     list_append(self.oscTitles, (unitype) self.windows[oscIndex].title, 's');
@@ -739,9 +1518,9 @@ void createNewOsc() {
     self.windows[oscIndex].windowCoords[2] = 37;
     self.windows[oscIndex].windowCoords[3] = 167;
     self.windows[oscIndex].windowTop = 15;
-    self.windows[oscIndex].windowSide = 100;
+    self.windows[oscIndex].windowSide = 220;
     self.windows[oscIndex].windowMinX = 100 + self.windows[oscIndex].windowSide;
-    self.windows[oscIndex].windowMinY = 150 + self.windows[oscIndex].windowTop;
+    self.windows[oscIndex].windowMinY = 255 + self.windows[oscIndex].windowTop;
     self.windows[oscIndex].minimize = 0;
     self.windows[oscIndex].move = 0;
     self.windows[oscIndex].click = 0;
@@ -754,14 +1533,47 @@ void createNewOsc() {
     list_append(self.windows[oscIndex].dials, (unitype) (void *) dialInit("Scale", &self.osc[self.newOsc].dummyTopBound, WINDOW_OSC * pow2(self.newOsc), DIAL_EXP, -25, -60 - self.windows[oscIndex].windowTop, 8, 1, 10000, 1), 'p');
     list_append(self.windows[oscIndex].dials, (unitype) (void *) dialInit("Offset", &self.osc[self.newOsc].dummyOffset, WINDOW_OSC * pow2(self.newOsc), DIAL_LINEAR, -25, -95 - self.windows[oscIndex].windowTop, 8, -1000, 1000, 1), 'p');
     list_append(self.windows[oscIndex].switches, (unitype) (void *) switchInit("Pause", &self.osc[self.newOsc].stop, WINDOW_OSC * pow2(self.newOsc), -25, -135 - self.windows[oscIndex].windowTop, 8), 'p');
-    list_append(self.windows[oscIndex].dials, (unitype) (void *) dialInit("Threshold", &self.osc[self.newOsc].trigger.threshold, WINDOW_OSC * pow2(self.newOsc), DIAL_LINEAR, -75, -135 - self.windows[oscIndex].windowTop, 8, -100, 100, 1), 'p');
+    list_append(self.windows[oscIndex].dials, (unitype) (void *) dialInit("Threshold", &self.osc[self.newOsc].trigger.threshold[0], WINDOW_OSC * pow2(self.newOsc), DIAL_LINEAR, -75, -135 - self.windows[oscIndex].windowTop, 8, -100, 100, 1), 'p');
+    list_append(self.windows[oscIndex].dials, (unitype) (void *) dialInit("Hold (ms)", &self.osc[self.newOsc].trigger.holdoffMicroseconds, WINDOW_OSC * pow2(self.newOsc), DIAL_EXP, -75, -170 - self.windows[oscIndex].windowTop, 8, 0, 1000000, 1000), 'p');
+    list_append(self.windows[oscIndex].dials, (unitype) (void *) dialInit("Auto (ms)", &self.osc[self.newOsc].trigger.timeoutMicroseconds, WINDOW_OSC * pow2(self.newOsc), DIAL_EXP, -25, -170 - self.windows[oscIndex].windowTop, 8, 1000, 10000000, 1000), 'p');
+    list_append(self.windows[oscIndex].dials, (unitype) (void *) dialInit("Pre (%)", &self.osc[self.newOsc].preTrigger, WINDOW_OSC * pow2(self.newOsc), DIAL_LINEAR, -75, -240 - self.windows[oscIndex].windowTop, 8, 0, 100, 1), 'p');
+    list_append(self.windows[oscIndex].buttons, (unitype) (void *) buttonInit("Arm", &self.osc[self.newOsc].arm, WINDOW_OSC * pow2(self.newOsc), -25, -240 - self.windows[oscIndex].windowTop, 8, BUTTON_SHAPE_RECTANGLE), 'p');
+    list_t *modeOptions = list_init();
+    list_append(modeOptions, (unitype) "Auto", 's');
+    list_append(modeOptions, (unitype) "Normal", 's');
+    list_append(modeOptions, (unitype) "Single", 's');
+    list_append(self.windows[oscIndex].dials, (unitype) (void *) dialInit("Level 2", &self.osc[self.newOsc].trigger.level2[0], WINDOW_OSC * pow2(self.newOsc), DIAL_LINEAR, -25, -205 - self.windows[oscIndex].windowTop, 8, -100, 100, 1), 'p');
+    list_append(self.windows[oscIndex].dials, (unitype) (void *) dialInit("Min (us)", &self.osc[self.newOsc].trigger.widthMinMicroseconds[0], WINDOW_OSC * pow2(self.newOsc), DIAL_EXP, -140, -65 - self.windows[oscIndex].windowTop, 8, 0, 100000, 1), 'p');
+    list_append(self.windows[oscIndex].dials, (unitype) (void *) dialInit("Max (us)", &self.osc[self.newOsc].trigger.widthMaxMicroseconds[0], WINDOW_OSC * pow2(self.newOsc), DIAL_EXP, -140, -100 - self.windows[oscIndex].windowTop, 8, 0, 100000, 1), 'p');
+    list_append(self.windows[oscIndex].dials, (unitype) (void *) dialInit("Thresh B", &self.osc[self.newOsc].trigger.threshold[1], WINDOW_OSC * pow2(self.newOsc), DIAL_LINEAR, -140, -240 - self.windows[oscIndex].windowTop, 8, -100, 100, 1), 'p');
+    list_append(self.windows[oscIndex].dials, (unitype) (void *) dialInit("Min B", &self.osc[self.newOsc].trigger.widthMinMicroseconds[1], WINDOW_OSC * pow2(self.newOsc), DIAL_EXP, -190, -170 - self.windows[oscIndex].windowTop, 8, 0, 100000, 1), 'p');
+    list_append(self.windows[oscIndex].dials, (unitype) (void *) dialInit("Max B", &self.osc[self.newOsc].trigger.widthMaxMicroseconds[1], WINDOW_OSC * pow2(self.newOsc), DIAL_EXP, -190, -205 - self.windows[oscIndex].windowTop, 8, 0, 100000, 1), 'p');
+    list_append(self.windows[oscIndex].dials, (unitype) (void *) dialInit("Level 2 B", &self.osc[self.newOsc].trigger.level2[1], WINDOW_OSC * pow2(self.newOsc), DIAL_LINEAR, -190, -240 - self.windows[oscIndex].windowTop, 8, -100, 100, 1), 'p');
     list_t *triggerOptions = list_init();
     list_append(triggerOptions, (unitype) "None", 's');
     list_append(triggerOptions, (unitype) "Rising", 's');
     list_append(triggerOptions, (unitype) "Falling", 's');
+    list_append(triggerOptions, (unitype) "Pulse+", 's');
+    list_append(triggerOptions, (unitype) "Pulse-", 's');
+    list_append(triggerOptions, (unitype) "Win in", 's');
+    list_append(triggerOptions, (unitype) "Win out", 's');
+    list_append(triggerOptions, (unitype) "Runt+", 's');
+    list_append(triggerOptions, (unitype) "Runt-", 's');
+    list_append(triggerOptions, (unitype) "Slope+", 's');
+    list_append(triggerOptions, (unitype) "Slope-", 's');
+    list_t *logicOptions = list_init();
+    list_append(logicOptions, (unitype) "Off", 's');
+    list_append(logicOptions, (unitype) "AND", 's');
+    list_append(logicOptions, (unitype) "OR", 's');
     dropdown_metadata_t metadata;
     metadata.inUse = 0;
-    list_append(self.windows[oscIndex].dropdowns, (unitype) (void *) dropdownInit("Trigger", triggerOptions, &self.osc[self.newOsc].trigger.type, WINDOW_OSC * pow2(self.newOsc), -70, -100 - self.windows[oscIndex].windowTop, 8, metadata), 'p');
+    /* second condition and trigger sources, lowest first so open lists draw over the dropdowns below them */
+    list_append(self.windows[oscIndex].dropdowns, (unitype) (void *) dropdownInit("Trigger B", triggerOptions, &self.osc[self.newOsc].trigger.type[1], WINDOW_OSC * pow2(self.newOsc), -135, -205 - self.windows[oscIndex].windowTop, 8, metadata), 'p');
+    list_append(self.windows[oscIndex].dropdowns, (unitype) (void *) dropdownInit("Source B", self.triggerSources, &self.osc[self.newOsc].trigger.source[1], WINDOW_OSC * pow2(self.newOsc), -135, -170 - self.windows[oscIndex].windowTop, 8, metadata), 'p');
+    list_append(self.windows[oscIndex].dropdowns, (unitype) (void *) dropdownInit("Logic", logicOptions, &self.osc[self.newOsc].trigger.logic, WINDOW_OSC * pow2(self.newOsc), -135, -135 - self.windows[oscIndex].windowTop, 8, metadata), 'p');
+    list_append(self.windows[oscIndex].dropdowns, (unitype) (void *) dropdownInit("Source", self.triggerSources, &self.osc[self.newOsc].trigger.source[0], WINDOW_OSC * pow2(self.newOsc), -135, -30 - self.windows[oscIndex].windowTop, 8, metadata), 'p');
+    list_append(self.windows[oscIndex].dropdowns, (unitype) (void *) dropdownInit("Mode", modeOptions, &self.osc[self.newOsc].mode, WINDOW_OSC * pow2(self.newOsc), -70, -205 - self.windows[oscIndex].windowTop, 8, metadata), 'p');
+    list_append(self.windows[oscIndex].dropdowns, (unitype) (void *) dropdownInit("Trigger", triggerOptions, &self.osc[self.newOsc].trigger.type[0], WINDOW_OSC * pow2(self.newOsc), -70, -100 - self.windows[oscIndex].windowTop, 8, metadata), 'p');
     metadata.inUse = 1;
     metadata.selectIndex = 3;
     metadata.color[0] = self.themeColors[self.theme + 33];
@@ -799,9 +1611,17 @@ void createNewOrbit() {
     self.orbit[self.newOrbit].scale[1] = 70;
     self.orbit[self.newOrbit].offset[0] = 0;
     self.orbit[self.newOrbit].offset[1] = 0;
-    self.orbit[self.newOrbit].stopIndex[0] = 1;
-    self.orbit[self.newOrbit].stopIndex[1] = 1;
+    self.orbit[self.newOrbit].stopIndex = 0;
     self.orbit[self.newOrbit].samples = 20;
+    for (int i = 0; i < 2; i++) {
+        if (self.orbit[self.newOrbit].merged[i] == NULL) {
+            self.orbit[self.newOrbit].merged[i] = channel_init(ORBIT_MERGE_LENGTH);
+        }
+        self.orbit[self.newOrbit].mergedSource[i] = NULL; // forces a rebuild
+    }
+    if (self.orbit[self.newOrbit].grid.x == NULL) {
+        pointgrid_init(&self.orbit[self.newOrbit].grid, ORBIT_MERGE_LENGTH, 1, 1);
+    }
     int orbitIndex = ilog2(WINDOW_ORBIT) + self.newOrbit;
     sprintf(self.windows[orbitIndex].title, "Orbit %d", self.newOrbit + 1);
     self.windows[orbitIndex].windowCoords[0] = -317;
@@ -828,7 +1648,7 @@ void createNewOrbit() {
     list_append(self.windows[orbitIndex].dials, (unitype) (void *) dialInit("Scale", &self.orbit[self.newOrbit].scale[1], WINDOW_ORBIT * pow2(self.newOrbit), DIAL_EXP, -55, -60 - self.windows[orbitIndex].windowTop, 8, 1, 500, 1), 'p');
     list_append(self.windows[orbitIndex].dials, (unitype) (void *) dialInit("Offset", &self.orbit[self.newOrbit].offset[0], WINDOW_ORBIT * pow2(self.newOrbit), DIAL_LINEAR, -20, -25 - self.windows[orbitIndex].windowTop, 8, 500, -500, 1), 'p');
     list_append(self.windows[orbitIndex].dials, (unitype) (void *) dialInit("Offset", &self.orbit[self.newOrbit].offset[1], WINDOW_ORBIT * pow2(self.newOrbit), DIAL_LINEAR, -20, -60 - self.windows[orbitIndex].windowTop, 8, -500, 500, 1), 'p');
-    list_append(self.windows[orbitIndex].dials, (unitype) (void *) dialInit("Samples", &self.orbit[self.newOrbit].samples, WINDOW_ORBIT * pow2(self.newOrbit), DIAL_EXP, -90, -95 - self.windows[orbitIndex].windowTop, 8, 1, 500, 1), 'p');
+    list_append(self.windows[orbitIndex].dials, (unitype) (void *) dialInit("Samples", &self.orbit[self.newOrbit].samples, WINDOW_ORBIT * pow2(self.newOrbit), DIAL_EXP, -90, -95 - self.windows[orbitIndex].windowTop, 8, 1, TRACEGL_MIRROR_LENGTH, 1), 'p');
     list_append(self.windows[orbitIndex].switches, (unitype) (void *) switchInit("Pause", &self.orbit[self.newOrbit].stop, WINDOW_ORBIT * pow2(self.newOrbit), -20, -95 - self.windows[orbitIndex].windowTop, 8), 'p');
     list_append(self.windowRender, (unitype) (WINDOW_ORBIT * pow2(self.newOrbit)), 'i');
     self.newOrbit++;
@@ -838,6 +1658,7 @@ void createNewOrbit() {
 void init() {
 /* comms */
     self.threadCloseSignal = 0;
+    self.commsThreadRunning = 0;
     self.maxSlots = 0;
     for (int i = 0; i < TCP_RECEIVE_BUFFER_LENGTH; i++) {
         self.tcpAsciiReceiveBuffer[i] = 0;
@@ -889,9 +1710,15 @@ void init() {
     self.logVariables = list_init();
     self.usedVariableIndices = list_init();
     self.oldUsedVariableIndices = list_init();
-    logVariable_t *dummyVariable = variableInit("Unused", -1, NULL, -1, -1);
+    logVariable_t *dummyVariable = variableInit("Unused", -1, 120.0, NULL, -1);
     list_append(self.logVariables, (unitype) (void *) dummyVariable, 'p');
     self.data = list_init();
+    self.traceMirrors = list_init();
+    self.triggerSources = list_init();
+    self.retentionSeconds = 60;
+    self.retentionSamples = 0;
+    loadConfig("include/empvConfig.txt");
+    self.appliedRetentionSeconds = self.retentionSeconds;
     populateLoggedVariables(); // gather logged variables
     self.windowRender = list_init();
     list_append(self.windowRender, (unitype) WINDOW_FREQ, 'i');
@@ -906,9 +1733,63 @@ void init() {
     self.oscTitles = list_init();
     createNewOsc();
     /* frequency */
-    self.windowData = list_init();
-    self.freqData = list_init();
-    self.phaseData = list_init();
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < FREQ_CHANNELS; j++) {
+            self.freqRequest[i].input[j] = (freq_input_t) {{NULL, 0}, 0, 0, 1};
+        }
+        self.freqRequest[i].inputs = 0;
+        self.freqRequest[i].fftLength = 0;
+        self.freqRequest[i].hop = 0;
+        self.freqRequest[i].window = SPECTRUM_WINDOW_TAPER;
+        self.freqRequest[i].average = FREQ_AVERAGE_OFF;
+        self.freqRequest[i].averages = 1;
+        self.freqRequest[i].reset = 1;
+    }
+    for (int i = 0; i < 2; i++) {
+        for (int j = 0; j < FREQ_CHANNELS; j++) {
+            self.freqSpectra[i].spectrum[j].magnitude = (spectrum_buffer_t) {NULL, 0};
+            self.freqSpectra[i].spectrum[j].phase = (spectrum_buffer_t) {NULL, 0};
+            self.freqSpectra[i].spectrum[j].bins = 0;
+            self.freqSpectra[i].spectrum[j].fftLength = 0;
+            self.freqSpectra[i].spectrum[j].channel = 0;
+            self.freqSpectra[i].spectrum[j].samplesPerSecond = 1;
+        }
+        self.freqSpectra[i].count = 0;
+    }
+    for (int i = 0; i < FREQ_CHANNELS; i++) {
+        self.freqChannel[i] = NULL;
+        self.freqLeft[i] = 0;
+        self.freqRight[i] = 0;
+        self.welchChannel[i] = NULL;
+        self.welchNext[i] = 0;
+        self.freqAccumulator[i] = (freq_accumulator_t) {{NULL, 0}, {NULL, 0}, {NULL, 0}, {NULL, 0}, {NULL, 0}, 0, 0};
+    }
+    self.freqRequestWaiting = 0;
+    self.freqSpectrumReady = 0;
+    self.freqPlan = NULL;
+    self.freqSubmittedInputs = 0;
+    self.freqSubmittedLength = 0;
+    self.freqSubmittedWindow = SPECTRUM_WINDOW_TAPER;
+    self.freqLengthMode = FREQ_LENGTH_FAST;
+    self.freqWindowMode = SPECTRUM_WINDOW_TAPER;
+    self.freqAverageMode = FREQ_AVERAGE_OFF;
+    self.freqOverlap = 50;
+    self.freqAverages = 16;
+    self.freqReset = 0;
+    self.freqAllChannels = 0;
+    self.welchInputs = 0;
+    self.welchLength = 0;
+    self.welchWindow = SPECTRUM_WINDOW_TAPER;
+    self.welchAverage = FREQ_AVERAGE_OFF;
+    self.welchAverages = 0;
+    self.welchReset = 1;
+    self.freqWindow = (spectrum_buffer_t) {NULL, 0};
+    self.freqWindowType = -1;
+    self.freqWindowLength = 0;
+    self.freqWindowSum = 1;
+    self.freqRevision = 0;
+    self.freqSubmittedRevision = 0;
+    freqThreadStart();
     self.freqOscIndex = 0;
     self.freqOscChannel = 0;
     self.freqLeftBound = 0;
@@ -924,7 +1805,7 @@ void init() {
     self.windows[freqIndex].windowTop = 15;
     self.windows[freqIndex].windowSide = 50;
     self.windows[freqIndex].windowMinX = 100 + self.windows[freqIndex].windowSide;
-    self.windows[freqIndex].windowMinY = 120 + self.windows[freqIndex].windowTop;
+    self.windows[freqIndex].windowMinY = 255 + self.windows[freqIndex].windowTop;
     self.windows[freqIndex].minimize = 0;
     self.windows[freqIndex].move = 0;
     self.windows[freqIndex].click = 0;
@@ -939,8 +1820,32 @@ void init() {
     list_append(freqChannels, (unitype) "Channel 2", 's');
     list_append(freqChannels, (unitype) "Channel 3", 's');
     list_append(freqChannels, (unitype) "Channel 4", 's');
+    list_t *lengthOptions = list_init();
+    list_append(lengthOptions, (unitype) "Fast", 's');
+    list_append(lengthOptions, (unitype) "Pow2", 's');
+    for (int i = 0; i < sizeof(freqFixedLengths) / sizeof(int); i++) {
+        char lengthName[16];
+        sprintf(lengthName, "%d", freqFixedLengths[i]);
+        list_append(lengthOptions, (unitype) lengthName, 's');
+    }
     dropdown_metadata_t metadata;
     metadata.inUse = 0;
+    list_t *windowOptions = list_init();
+    list_append(windowOptions, (unitype) "Taper", 's');
+    list_append(windowOptions, (unitype) "Hann", 's');
+    list_append(windowOptions, (unitype) "B-Harris", 's');
+    list_append(windowOptions, (unitype) "Flat top", 's');
+    list_t *averageOptions = list_init();
+    list_append(averageOptions, (unitype) "Off", 's');
+    list_append(averageOptions, (unitype) "Linear", 's');
+    list_append(averageOptions, (unitype) "Exp", 's');
+    list_append(self.windows[freqIndex].dials, (unitype) (void *) dialInit("Overlap", &self.freqOverlap, WINDOW_FREQ, DIAL_LINEAR, -75, -205 - self.windows[freqIndex].windowTop, 8, 0, 95, 1), 'p');
+    list_append(self.windows[freqIndex].dials, (unitype) (void *) dialInit("Averages", &self.freqAverages, WINDOW_FREQ, DIAL_EXP, -25, -205 - self.windows[freqIndex].windowTop, 8, 1, 1000, 1), 'p');
+    list_append(self.windows[freqIndex].buttons, (unitype) (void *) buttonInit("Reset", &self.freqReset, WINDOW_FREQ, -25, -240 - self.windows[freqIndex].windowTop, 8, BUTTON_SHAPE_RECTANGLE), 'p');
+    list_append(self.windows[freqIndex].switches, (unitype) (void *) switchInit("All", &self.freqAllChannels, WINDOW_FREQ, -75, -240 - self.windows[freqIndex].windowTop, 8), 'p');
+    list_append(self.windows[freqIndex].dropdowns, (unitype) (void *) dropdownInit("Average", averageOptions, &self.freqAverageMode, pow2(freqIndex), -20, -170 - self.windows[freqIndex].windowTop, 8, metadata), 'p');
+    list_append(self.windows[freqIndex].dropdowns, (unitype) (void *) dropdownInit("Window", windowOptions, &self.freqWindowMode, pow2(freqIndex), -20, -135 - self.windows[freqIndex].windowTop, 8, metadata), 'p');
+    list_append(self.windows[freqIndex].dropdowns, (unitype) (void *) dropdownInit("FFT N", lengthOptions, &self.freqLengthMode, pow2(freqIndex), -20, -100 - self.windows[freqIndex].windowTop, 8, metadata), 'p');
     list_append(self.windows[freqIndex].dropdowns, (unitype) (void *) dropdownInit(NULL, freqChannels, &self.freqOscChannel, pow2(freqIndex), -20, -65 - self.windows[freqIndex].windowTop, 8, metadata), 'p');
     list_append(self.windows[freqIndex].dropdowns, (unitype) (void *) dropdownInit(NULL, self.oscTitles, &self.freqOscIndex, pow2(freqIndex), -20, -45 - self.windows[freqIndex].windowTop, 8, metadata), 'p');
     self.windows[freqIndex].dropdownLogicIndex = -1;
@@ -988,6 +1893,213 @@ void init() {
     self.windows[infoIndex].dropdowns = list_init();
     self.windows[infoIndex].buttons = list_init();
     list_append(self.windows[infoIndex].buttons, (unitype) (void *) buttonInit("Refresh", &self.infoRefresh, WINDOW_INFO, -22, -24, 8, BUTTON_SHAPE_RECTANGLE), 'p');
+    list_append(self.windows[infoIndex].dials, (unitype) (void *) dialInit("Keep (s)", &self.retentionSeconds, WINDOW_INFO, DIAL_EXP, -22, -65, 8, 1, 3600, 1), 'p');
+    /* spectrogram */
+    self.spectrogram.dataIndex = 0;
+    self.spectrogram.sizeIndex = 2;
+    self.spectrogram.hopIndex = 1;
+    self.spectrogram.window = SPECTRUM_WINDOW_HANN;
+    self.spectrogram.colormap = SPECTROGRAM_VIRIDIS;
+    self.spectrogram.top = 20;
+    self.spectrogram.range = 80;
+    self.spectrogram.channel = NULL;
+    self.spectrogram.size = 0;
+    self.spectrogram.hop = 0;
+    self.spectrogram.windowType = -1;
+    self.spectrogram.appliedColormap = -1;
+    self.spectrogram.samplesPerSecond = 1;
+    self.spectrogram.next = 0;
+    self.spectrogram.columns = 0;
+    self.spectrogram.coefficients = (spectrum_buffer_t) {NULL, 0};
+    self.spectrogram.windowSum = 1;
+    self.spectrogram.block = (spectrum_buffer_t) {NULL, 0};
+    self.spectrogram.segment = (spectrum_buffer_t) {NULL, 0};
+    self.spectrogram.power = (spectrum_buffer_t) {NULL, 0};
+    self.spectrogram.bins = (spectrum_buffer_t) {NULL, 0};
+    self.spectrogram.work = (spectrum_buffer_t) {NULL, 0};
+    self.spectrogram.pending = (spectrum_buffer_t) {NULL, 0};
+    self.spectrogram.history = (spectrum_buffer_t) {NULL, 0};
+    self.spectrogram.image = NULL;
+    int spectrogramIndex = ilog2(WINDOW_SPECTROGRAM);
+    strcpy(self.windows[spectrogramIndex].title, "Spectrogram");
+    self.windows[spectrogramIndex].windowCoords[0] = -317;
+    self.windows[spectrogramIndex].windowCoords[1] = -161;
+    self.windows[spectrogramIndex].windowCoords[2] = -60;
+    self.windows[spectrogramIndex].windowCoords[3] = -3;
+    self.windows[spectrogramIndex].windowTop = 15;
+    self.windows[spectrogramIndex].windowSide = 50;
+    self.windows[spectrogramIndex].windowMinX = 100 + self.windows[spectrogramIndex].windowSide;
+    self.windows[spectrogramIndex].windowMinY = 220 + self.windows[spectrogramIndex].windowTop;
+    self.windows[spectrogramIndex].minimize = 1; // opened from the bottom bar
+    self.windows[spectrogramIndex].move = 0;
+    self.windows[spectrogramIndex].click = 0;
+    self.windows[spectrogramIndex].resize = 0;
+    self.windows[spectrogramIndex].dials = list_init();
+    self.windows[spectrogramIndex].switches = list_init();
+    self.windows[spectrogramIndex].dropdowns = list_init();
+    self.windows[spectrogramIndex].buttons = list_init();
+    list_t *sizeOptions = list_init();
+    for (int i = 0; i < sizeof(spectrogramSizes) / sizeof(int); i++) {
+        char sizeName[16];
+        sprintf(sizeName, "%d", spectrogramSizes[i]);
+        list_append(sizeOptions, (unitype) sizeName, 's');
+    }
+    list_t *hopOptions = list_init();
+    for (int i = 0; i < sizeof(spectrogramHops) / sizeof(int); i++) {
+        char hopName[16];
+        sprintf(hopName, "N/%d", spectrogramHops[i]);
+        list_append(hopOptions, (unitype) hopName, 's');
+    }
+    list_t *spectrogramWindowOptions = list_init();
+    list_append(spectrogramWindowOptions, (unitype) "Taper", 's');
+    list_append(spectrogramWindowOptions, (unitype) "Hann", 's');
+    list_append(spectrogramWindowOptions, (unitype) "B-Harris", 's');
+    list_append(spectrogramWindowOptions, (unitype) "Flat top", 's');
+    list_t *colormapOptions = list_init();
+    list_append(colormapOptions, (unitype) "Viridis", 's');
+    list_append(colormapOptions, (unitype) "Inferno", 's');
+    list_append(colormapOptions, (unitype) "Gray", 's');
+    list_append(colormapOptions, (unitype) "Jet", 's');
+    dropdown_metadata_t spectrogramMetadata;
+    spectrogramMetadata.inUse = 0;
+    list_append(self.windows[spectrogramIndex].dials, (unitype) (void *) dialInit("Top (dB)", &self.spectrogram.top, WINDOW_SPECTROGRAM, DIAL_LINEAR, -75, -205 - self.windows[spectrogramIndex].windowTop, 8, -100, 100, 1), 'p');
+    list_append(self.windows[spectrogramIndex].dials, (unitype) (void *) dialInit("Range", &self.spectrogram.range, WINDOW_SPECTROGRAM, DIAL_LINEAR, -25, -205 - self.windows[spectrogramIndex].windowTop, 8, 10, 160, 1), 'p');
+    list_append(self.windows[spectrogramIndex].dropdowns, (unitype) (void *) dropdownInit("Colors", colormapOptions, &self.spectrogram.colormap, WINDOW_SPECTROGRAM, -20, -170 - self.windows[spectrogramIndex].windowTop, 8, spectrogramMetadata), 'p');
+    list_append(self.windows[spectrogramIndex].dropdowns, (unitype) (void *) dropdownInit("Window", spectrogramWindowOptions, &self.spectrogram.window, WINDOW_SPECTROGRAM, -20, -135 - self.windows[spectrogramIndex].windowTop, 8, spectrogramMetadata), 'p');
+    list_append(self.windows[spectrogramIndex].dropdowns, (unitype) (void *) dropdownInit("Hop", hopOptions, &self.spectrogram.hopIndex, WINDOW_SPECTROGRAM, -20, -100 - self.windows[spectrogramIndex].windowTop, 8, spectrogramMetadata), 'p');
+    list_append(self.windows[spectrogramIndex].dropdowns, (unitype) (void *) dropdownInit("FFT N", sizeOptions, &self.spectrogram.sizeIndex, WINDOW_SPECTROGRAM, -20, -65 - self.windows[spectrogramIndex].windowTop, 8, spectrogramMetadata), 'p');
+    list_append(self.windows[spectrogramIndex].dropdowns, (unitype) (void *) dropdownInit("Source", self.logVariables, &self.spectrogram.dataIndex, WINDOW_SPECTROGRAM, -20, -30 - self.windows[spectrogramIndex].windowTop, 8, spectrogramMetadata), 'p');
+    self.windows[spectrogramIndex].dropdownLogicIndex = -1;
+    list_insert(self.windowRender, 0, (unitype) WINDOW_SPECTROGRAM, 'i');
+    /* harmonics */
+    for (int i = 0; i < 4; i++) {
+        self.harmonic.channel[i].channel = NULL;
+    }
+    self.harmonic.oscIndex = 0;
+    self.harmonic.trendChannel = 0;
+    self.harmonic.reference = HARMONIC_FIXED;
+    self.harmonic.referenceIndex = 0;
+    self.harmonic.fundamental = 50;
+    self.harmonic.harmonicsDial = 8;
+    self.harmonic.cycles = 4;
+    self.harmonic.harmonics = 0;
+    self.harmonic.appliedReference = -1;
+    self.harmonic.appliedReferenceIndex = -1;
+    self.harmonic.appliedOsc = -1;
+    self.harmonic.trendHead = 0;
+    self.harmonic.trendLength = 0;
+    int harmonicIndex = ilog2(WINDOW_HARMONIC);
+    strcpy(self.windows[harmonicIndex].title, "Harmonics");
+    self.windows[harmonicIndex].windowCoords[0] = -200;
+    self.windows[harmonicIndex].windowCoords[1] = -120;
+    self.windows[harmonicIndex].windowCoords[2] = 150;
+    self.windows[harmonicIndex].windowCoords[3] = 140;
+    self.windows[harmonicIndex].windowTop = 15;
+    self.windows[harmonicIndex].windowSide = 60;
+    self.windows[harmonicIndex].windowMinX = 150 + self.windows[harmonicIndex].windowSide;
+    self.windows[harmonicIndex].windowMinY = 230 + self.windows[harmonicIndex].windowTop;
+    self.windows[harmonicIndex].minimize = 1; // opened from the bottom bar
+    self.windows[harmonicIndex].move = 0;
+    self.windows[harmonicIndex].click = 0;
+    self.windows[harmonicIndex].resize = 0;
+    self.windows[harmonicIndex].dials = list_init();
+    self.windows[harmonicIndex].switches = list_init();
+    self.windows[harmonicIndex].dropdowns = list_init();
+    self.windows[harmonicIndex].buttons = list_init();
+    list_t *harmonicChannels = list_init();
+    list_append(harmonicChannels, (unitype) "Channel 1", 's');
+    list_append(harmonicChannels, (unitype) "Channel 2", 's');
+    list_append(harmonicChannels, (unitype) "Channel 3", 's');
+    list_append(harmonicChannels, (unitype) "Channel 4", 's');
+    list_t *referenceOptions = list_init();
+    list_append(referenceOptions, (unitype) "Fixed", 's');
+    list_append(referenceOptions, (unitype) "Speed (Hz)", 's');
+    list_append(referenceOptions, (unitype) "Angle (rad)", 's');
+    dropdown_metadata_t harmonicMetadata;
+    harmonicMetadata.inUse = 0;
+    list_append(self.windows[harmonicIndex].dials, (unitype) (void *) dialInit("f0 (Hz)", &self.harmonic.fundamental, WINDOW_HARMONIC, DIAL_EXP, -25, -25 - self.windows[harmonicIndex].windowTop, 8, 1, 10000, 1), 'p');
+    list_append(self.windows[harmonicIndex].dials, (unitype) (void *) dialInit("Harmonics", &self.harmonic.harmonicsDial, WINDOW_HARMONIC, DIAL_LINEAR, -75, -170 - self.windows[harmonicIndex].windowTop, 8, 1, HARMONIC_MAX, 1), 'p');
+    list_append(self.windows[harmonicIndex].dials, (unitype) (void *) dialInit("Cycles", &self.harmonic.cycles, WINDOW_HARMONIC, DIAL_LINEAR, -25, -170 - self.windows[harmonicIndex].windowTop, 8, 1, 50, 1), 'p');
+    list_append(self.windows[harmonicIndex].dropdowns, (unitype) (void *) dropdownInit("Reference", self.logVariables, &self.harmonic.referenceIndex, WINDOW_HARMONIC, -20, -135 - self.windows[harmonicIndex].windowTop, 8, harmonicMetadata), 'p');
+    list_append(self.windows[harmonicIndex].dropdowns, (unitype) (void *) dropdownInit("Fundamental", referenceOptions, &self.harmonic.reference, WINDOW_HARMONIC, -20, -100 - self.windows[harmonicIndex].windowTop, 8, harmonicMetadata), 'p');
+    list_append(self.windows[harmonicIndex].dropdowns, (unitype) (void *) dropdownInit(NULL, harmonicChannels, &self.harmonic.trendChannel, WINDOW_HARMONIC, -20, -65 - self.windows[harmonicIndex].windowTop, 8, harmonicMetadata), 'p');
+    list_append(self.windows[harmonicIndex].dropdowns, (unitype) (void *) dropdownInit(NULL, self.oscTitles, &self.harmonic.oscIndex, WINDOW_HARMONIC, -20, -45 - self.windows[harmonicIndex].windowTop, 8, harmonicMetadata), 'p');
+    self.windows[harmonicIndex].dropdownLogicIndex = -1;
+    list_insert(self.windowRender, 0, (unitype) WINDOW_HARMONIC, 'i');
+    /* bode */
+    self.bode.inputIndex = 0;
+    self.bode.outputIndex = 0;
+    self.bode.sizeIndex = 2;
+    self.bode.window = SPECTRUM_WINDOW_HANN;
+    self.bode.overlap = 50;
+    self.bode.averages = 16;
+    self.bode.reset = 0;
+    self.bode.top = 20;
+    self.bode.range = 80;
+    self.bode.input = NULL;
+    self.bode.output = NULL;
+    self.bode.size = 0;
+    self.bode.hop = 0;
+    self.bode.windowType = -1;
+    self.bode.appliedAverages = 0;
+    self.bode.samplesPerSecond = 1;
+    self.bode.rateMismatch = 0;
+    self.bode.next = 0;
+    self.bode.offset = 0;
+    self.bode.segments = 0;
+    self.bode.plan = NULL;
+    self.bode.coefficients = (spectrum_buffer_t) {NULL, 0};
+    self.bode.windowSum = 1;
+    self.bode.samples = (spectrum_buffer_t) {NULL, 0};
+    self.bode.segment = (spectrum_buffer_t) {NULL, 0};
+    self.bode.bins = (spectrum_buffer_t) {NULL, 0};
+    self.bode.work = (spectrum_buffer_t) {NULL, 0};
+    self.bode.transforms = (spectrum_buffer_t) {NULL, 0};
+    self.bode.inputPower = (spectrum_buffer_t) {NULL, 0};
+    self.bode.outputPower = (spectrum_buffer_t) {NULL, 0};
+    self.bode.cross = (spectrum_buffer_t) {NULL, 0};
+    int bodeIndex = ilog2(WINDOW_BODE);
+    strcpy(self.windows[bodeIndex].title, "Bode");
+    self.windows[bodeIndex].windowCoords[0] = -200;
+    self.windows[bodeIndex].windowCoords[1] = -120;
+    self.windows[bodeIndex].windowCoords[2] = 150;
+    self.windows[bodeIndex].windowCoords[3] = 150;
+    self.windows[bodeIndex].windowTop = 15;
+    self.windows[bodeIndex].windowSide = 60;
+    self.windows[bodeIndex].windowMinX = 150 + self.windows[bodeIndex].windowSide;
+    self.windows[bodeIndex].windowMinY = 255 + self.windows[bodeIndex].windowTop;
+    self.windows[bodeIndex].minimize = 1; // opened from the bottom bar
+    self.windows[bodeIndex].move = 0;
+    self.windows[bodeIndex].click = 0;
+    self.windows[bodeIndex].resize = 0;
+    self.windows[bodeIndex].dials = list_init();
+    self.windows[bodeIndex].switches = list_init();
+    self.windows[bodeIndex].dropdowns = list_init();
+    self.windows[bodeIndex].buttons = list_init();
+    list_t *bodeSizeOptions = list_init();
+    for (int i = 0; i < sizeof(bodeSizes) / sizeof(int); i++) {
+        char sizeName[16];
+        sprintf(sizeName, "%d", bodeSizes[i]);
+        list_append(bodeSizeOptions, (unitype) sizeName, 's');
+    }
+    list_t *bodeWindowOptions = list_init();
+    list_append(bodeWindowOptions, (unitype) "Taper", 's');
+    list_append(bodeWindowOptions, (unitype) "Hann", 's');
+    list_append(bodeWindowOptions, (unitype) "B-Harris", 's');
+    list_append(bodeWindowOptions, (unitype) "Flat top", 's');
+    dropdown_metadata_t bodeMetadata;
+    bodeMetadata.inUse = 0;
+    list_append(self.windows[bodeIndex].dials, (unitype) (void *) dialInit("Top (dB)", &self.bode.top, WINDOW_BODE, DIAL_LINEAR, -75, -170 - self.windows[bodeIndex].windowTop, 8, -100, 100, 1), 'p');
+    list_append(self.windows[bodeIndex].dials, (unitype) (void *) dialInit("Range", &self.bode.range, WINDOW_BODE, DIAL_LINEAR, -25, -170 - self.windows[bodeIndex].windowTop, 8, 10, 160, 1), 'p');
+    list_append(self.windows[bodeIndex].dials, (unitype) (void *) dialInit("Overlap %", &self.bode.overlap, WINDOW_BODE, DIAL_LINEAR, -75, -205 - self.windows[bodeIndex].windowTop, 8, 0, 90, 1), 'p');
+    list_append(self.windows[bodeIndex].dials, (unitype) (void *) dialInit("Averages", &self.bode.averages, WINDOW_BODE, DIAL_EXP, -25, -205 - self.windows[bodeIndex].windowTop, 8, 1, 256, 1), 'p');
+    list_append(self.windows[bodeIndex].buttons, (unitype) (void *) buttonInit("Reset", &self.bode.reset, WINDOW_BODE, -25, -240 - self.windows[bodeIndex].windowTop, 8, BUTTON_SHAPE_RECTANGLE), 'p');
+    list_append(self.windows[bodeIndex].dropdowns, (unitype) (void *) dropdownInit("Window", bodeWindowOptions, &self.bode.window, WINDOW_BODE, -20, -135 - self.windows[bodeIndex].windowTop, 8, bodeMetadata), 'p');
+    list_append(self.windows[bodeIndex].dropdowns, (unitype) (void *) dropdownInit("FFT N", bodeSizeOptions, &self.bode.sizeIndex, WINDOW_BODE, -20, -100 - self.windows[bodeIndex].windowTop, 8, bodeMetadata), 'p');
+    list_append(self.windows[bodeIndex].dropdowns, (unitype) (void *) dropdownInit("Output", self.logVariables, &self.bode.outputIndex, WINDOW_BODE, -20, -65 - self.windows[bodeIndex].windowTop, 8, bodeMetadata), 'p');
+    list_append(self.windows[bodeIndex].dropdowns, (unitype) (void *) dropdownInit("Input", self.logVariables, &self.bode.inputIndex, WINDOW_BODE, -20, -30 - self.windows[bodeIndex].windowTop, 8, bodeMetadata), 'p');
+    self.windows[bodeIndex].dropdownLogicIndex = -1;
+    list_insert(self.windowRender, 0, (unitype) WINDOW_BODE, 'i');
 }
 
 /* UI elements */
@@ -1115,6 +2227,14 @@ void switchTick(int window) {
 void dropdownTick(int window) {
     if (self.windows[window].dropdowns -> length > 0) {
         self.windows[window].windowSide = 0;
+        /* the side bar also has to reach the leftmost dial and its label */
+        for (int i = 0; i < self.windows[window].dials -> length; i++) {
+            dial_t *dialp = (dial_t *) (self.windows[window].dials -> data[i].p);
+            double halfWidth = fmax(dialp -> size, textGLGetUnicodeLength(dialp -> label, dialp -> size - 1) / 2);
+            if (self.windows[window].windowSide < halfWidth - dialp -> position[0] + 10) {
+                self.windows[window].windowSide = halfWidth - dialp -> position[0] + 10;
+            }
+        }
     }
     int windowID = pow2(window);
     int logicIndex = -1;
@@ -1559,114 +2679,313 @@ void renderWindow(int window, char top) {
 
 void setBoundsNoTrigger(int oscIndex, int stopped) {
     if (!stopped) {
+        /* line the other channels up with the newest sample of the selected channel by time */
+        int selected = self.osc[oscIndex].dataIndex[self.osc[oscIndex].selectedChannel];
+        channel_t *selectedChannel = self.data -> data[selected].p;
+        double now = sampleTime(selected, selectedChannel -> length - 1);
         for (int i = 0; i < 4; i++) {
-            self.osc[oscIndex].rightBound[i] = self.data -> data[self.osc[oscIndex].dataIndex[i]].r -> length;
+            self.osc[oscIndex].rightBound[i] = ((channel_t *) self.data -> data[self.osc[oscIndex].dataIndex[i]].p) -> length;
+            if (selected > 0 && selectedChannel -> length > 0 && self.osc[oscIndex].dataIndex[i] > 0 && self.osc[oscIndex].dataIndex[i] != selected) {
+                int64_t aligned = floor(sampleIndexAtTime(self.osc[oscIndex].dataIndex[i], now) + 0.000001) + 1;
+                if (aligned < self.osc[oscIndex].rightBound[i]) {
+                    self.osc[oscIndex].rightBound[i] = aligned;
+                }
+            }
         }
     }
     for (int i = 0; i < 4; i++) {
+        int64_t start = channel_start(self.data -> data[self.osc[oscIndex].dataIndex[i]].p);
         if (self.osc[oscIndex].rightBound[i] - self.osc[oscIndex].leftBound[i] < self.osc[oscIndex].windowSizeSamples[i]) {
             self.osc[oscIndex].leftBound[i] = self.osc[oscIndex].rightBound[i] - self.osc[oscIndex].windowSizeSamples[i];
-            if (self.osc[oscIndex].leftBound[i] < 0) {
-                self.osc[oscIndex].leftBound[i] = 1;
-            }
         }
         if (self.osc[oscIndex].rightBound[i] > self.osc[oscIndex].leftBound[i] + self.osc[oscIndex].windowSizeSamples[i]) {
             self.osc[oscIndex].leftBound[i] = self.osc[oscIndex].rightBound[i] - self.osc[oscIndex].windowSizeSamples[i];
         }
+        /* older samples have been overwritten */
+        if (self.osc[oscIndex].leftBound[i] < start) {
+            self.osc[oscIndex].leftBound[i] = start;
+        }
+        if (self.osc[oscIndex].rightBound[i] < start) {
+            self.osc[oscIndex].rightBound[i] = start;
+        }
     }
 }
 
-void renderOscData(int oscIndex) {
-    int windowIndex = ilog2(WINDOW_OSC) + oscIndex;
-    for (int i = 0; i < 4; i++) {
-        self.osc[oscIndex].windowSizeSamples[i] = round((self.osc[oscIndex].windowSizeMicroseconds / 1000000) * self.data -> data[self.osc[oscIndex].dataIndex[i]].r -> data[0].d);
+/* channel an oscilloscope draws for one of its sources - the frozen capture while one is shown */
+channel_t *oscChannel(int oscIndex, int channel) {
+    if (self.osc[oscIndex].mode != OSC_MODE_AUTO && self.osc[oscIndex].captured) {
+        return self.osc[oscIndex].capture[channel];
     }
-    if (self.osc[oscIndex].oldSelectedChannel != self.osc[oscIndex].selectedChannel) {
-        self.osc[oscIndex].dummyOffset = (self.osc[oscIndex].topBound[self.osc[oscIndex].selectedChannel] + self.osc[oscIndex].bottomBound[self.osc[oscIndex].selectedChannel]) / -2;
-        if (fabs(self.osc[oscIndex].dummyOffset) < 0.01) {
-            self.osc[oscIndex].dummyOffset = 0;
+    return self.data -> data[self.osc[oscIndex].dataIndex[channel]].p;
+}
+
+/* GPU mirror of the channel an oscilloscope draws for one of its sources */
+traceGLMirror *oscMirror(int oscIndex, int channel) {
+    if (self.osc[oscIndex].mode != OSC_MODE_AUTO && self.osc[oscIndex].captured) {
+        if (self.osc[oscIndex].captureMirror[channel] == NULL) {
+            self.osc[oscIndex].captureMirror[channel] = traceGLMirrorInit();
         }
-        self.osc[oscIndex].dummyTopBound = self.osc[oscIndex].topBound[self.osc[oscIndex].selectedChannel] + self.osc[oscIndex].dummyOffset;
-        self.osc[oscIndex].oldSelectedChannel = self.osc[oscIndex].selectedChannel;
+        return self.osc[oscIndex].captureMirror[channel];
     }
-    self.osc[oscIndex].topBound[self.osc[oscIndex].selectedChannel] = self.osc[oscIndex].dummyTopBound - self.osc[oscIndex].dummyOffset;
-    self.osc[oscIndex].bottomBound[self.osc[oscIndex].selectedChannel] = self.osc[oscIndex].dummyTopBound * -1 - self.osc[oscIndex].dummyOffset;
-    /* set left and right bounds */
-    if (!self.osc[oscIndex].stop) {
-        if (self.osc[oscIndex].trigger.type == TRIGGER_NONE) {
-            list_clear(self.osc[oscIndex].trigger.lastIndex);
-            setBoundsNoTrigger(oscIndex, 0);
-        } else {
-            /* calculate difference in time from trigger point*/
-            double timeDifference = (self.data -> data[self.osc[oscIndex].dataIndex[self.osc[oscIndex].selectedChannel]].r -> length - self.osc[oscIndex].trigger.index) / self.data -> data[self.osc[oscIndex].dataIndex[self.osc[oscIndex].selectedChannel]].r -> data[0].d;
-            for (int i = 0; i < 4; i++) {
-                self.osc[oscIndex].rightBound[i] = self.data -> data[self.osc[oscIndex].dataIndex[i]].r -> length - timeDifference * self.data -> data[self.osc[oscIndex].dataIndex[i]].r -> data[0].d;
-                if (self.osc[oscIndex].rightBound[i] > self.data -> data[self.osc[oscIndex].dataIndex[i]].r -> length) {
-                    self.osc[oscIndex].rightBound[i] = self.data -> data[self.osc[oscIndex].dataIndex[i]].r -> length;
-                }
-                self.osc[oscIndex].leftBound[i] = self.osc[oscIndex].rightBound[i] - self.osc[oscIndex].windowSizeSamples[i];
-                if (self.osc[oscIndex].leftBound[i] < 0) {
-                    self.osc[oscIndex].leftBound[i] = 1;
-                }
-            }
+    return channelMirror(self.osc[oscIndex].dataIndex[channel]);
+}
 
-            /* identify triggerIndex (trigger index is right side of window) */
-            int dataLength = self.data -> data[self.osc[oscIndex].dataIndex[self.osc[oscIndex].selectedChannel]].r -> length;
-            if (self.osc[oscIndex].trigger.lastIndex -> length > 0 && self.osc[oscIndex].trigger.lastIndex -> data[0].i < dataLength) {
-                self.osc[oscIndex].trigger.index = self.osc[oscIndex].trigger.lastIndex -> data[0].i;
-                self.osc[oscIndex].trigger.timeout = 0;
-                list_delete(self.osc[oscIndex].trigger.lastIndex, 0);
-            }
-            self.osc[oscIndex].trigger.timeout++;
-            if (self.osc[oscIndex].trigger.timeout > TRIGGER_TIMEOUT) {
-                self.osc[oscIndex].trigger.index = 0;
-            }
-            if (self.osc[oscIndex].trigger.index == 0) {
-                setBoundsNoTrigger(oscIndex, 0);
-            }
-            int oldAbove = self.osc[oscIndex].above;
-            if (self.data -> data[self.osc[oscIndex].dataIndex[self.osc[oscIndex].selectedChannel]].r -> data[dataLength - 1].d >= self.osc[oscIndex].trigger.threshold) {
-                self.osc[oscIndex].above = 1;
-            } else {
-                self.osc[oscIndex].above = 0;
-            }
-            if (self.osc[oscIndex].trigger.type == TRIGGER_RISING_EDGE) {
-                if (oldAbove == 0 && self.osc[oscIndex].above == 1) {
-                    list_append(self.osc[oscIndex].trigger.lastIndex, (unitype) (dataLength - 2), 'i');
-                }
-            }
-            if (self.osc[oscIndex].trigger.type == TRIGGER_FALLING_EDGE) {
-                if (oldAbove == 1 && self.osc[oscIndex].above == 0) {
-                    list_append(self.osc[oscIndex].trigger.lastIndex, (unitype) (dataLength - 2), 'i');
-                }
-            }
-        }
-    } else {
-        setBoundsNoTrigger(oscIndex, 1);
+/* time in seconds of a sample of an oscilloscope source, see sampleTime */
+double oscSampleTime(int oscIndex, int channel, int64_t index) {
+    channel_t *source = oscChannel(oscIndex, channel);
+    if (source -> anchorLength > 0) {
+        return channel_time(source, index) * AMDC_TIMESTAMP_SECONDS;
     }
-    if (self.windows[windowIndex].minimize == 0) {
-        /* render window background */
-        turtleRectangle(self.windows[windowIndex].windowCoords[0], self.windows[windowIndex].windowCoords[1], self.windows[windowIndex].windowCoords[2], self.windows[windowIndex].windowCoords[3], self.themeColors[self.theme + 12], self.themeColors[self.theme + 13], self.themeColors[self.theme + 14], 0);
-        turtlePenSize(1);
-        double dashedY = self.windows[windowIndex].windowCoords[1] + (self.osc[oscIndex].trigger.threshold - self.osc[oscIndex].bottomBound[self.osc[oscIndex].selectedChannel]) / (self.osc[oscIndex].topBound[self.osc[oscIndex].selectedChannel] - self.osc[oscIndex].bottomBound[self.osc[oscIndex].selectedChannel]) * (self.windows[windowIndex].windowCoords[3] - self.windows[windowIndex].windowTop - self.windows[windowIndex].windowCoords[1]);
-        if (dashedY < self.windows[windowIndex].windowCoords[3] - self.windows[windowIndex].windowTop && dashedY > self.windows[windowIndex].windowCoords[1]) {
-            turtlePenShape("none");
-            turtlePenColorAlpha(0, 0, 0, 200);
-            double dashedX = self.windows[windowIndex].windowCoords[0] + (self.windows[windowIndex].windowCoords[2] - self.windows[windowIndex].windowCoords[0]) / 40;
-            for (int i = 0; i < 20; i++) {
-                turtleGoto(dashedX, dashedY);
-                turtlePenDown();
-                dashedX += (self.windows[windowIndex].windowCoords[2] - self.windows[windowIndex].windowCoords[0]) / 40;
-                turtleGoto(dashedX, dashedY);
-                turtlePenUp();
-                dashedX += (self.windows[windowIndex].windowCoords[2] - self.windows[windowIndex].windowCoords[0]) / 40;
-            }
+    return index / ((logVariable_t *) self.logVariables -> data[self.osc[oscIndex].dataIndex[channel]].p) -> samplesPerSecond;
+}
+
+/* fractional absolute index of an oscilloscope source at a time in seconds, see sampleIndexAtTime */
+double oscSampleIndexAtTime(int oscIndex, int channel, double time) {
+    channel_t *source = oscChannel(oscIndex, channel);
+    if (source -> anchorLength > 0) {
+        return channel_index_at(source, time / AMDC_TIMESTAMP_SECONDS);
+    }
+    return time * ((logVariable_t *) self.logVariables -> data[self.osc[oscIndex].dataIndex[channel]].p) -> samplesPerSecond;
+}
+
+/* lay the window out around a trigger point on the live channels - preTrigger percent of each channel's window before it, the rest after */
+void oscTriggerBounds(int oscIndex, trigger_point_t *point, int64_t *leftBound, int64_t *rightBound, double *phase) {
+    for (int i = 0; i < 4; i++) {
+        channel_t *channel = self.data -> data[self.osc[oscIndex].dataIndex[i]].p;
+        double preciseIndex = sampleIndexAtTime(self.osc[oscIndex].dataIndex[i], point -> time);
+        if (self.osc[oscIndex].dataIndex[i] == point -> dataIndex) {
+            preciseIndex = point -> index - 1 + point -> fraction;
         }
-        turtlePenColor(0, 0, 0);
-        turtlePenShape("circle");
-        turtleGoto(self.windows[windowIndex].windowCoords[0], (self.windows[windowIndex].windowCoords[1] - self.windows[windowIndex].windowTop + self.windows[windowIndex].windowCoords[3]) / 2);
-        turtlePenDown();
-        turtleGoto(self.windows[windowIndex].windowCoords[2], (self.windows[windowIndex].windowCoords[1] - self.windows[windowIndex].windowTop + self.windows[windowIndex].windowCoords[3]) / 2);
+        /* the trigger point falls phase samples after the last sample at or before it, traces are shifted so it lands on a sample column */
+        int64_t before = floor(preciseIndex + 0.000001);
+        phase[i] = preciseIndex - before;
+        if (phase[i] < 0) {
+            phase[i] = 0;
+        }
+        int64_t postSamples = round(self.osc[oscIndex].windowSizeSamples[i] * (1 - self.osc[oscIndex].preTrigger / 100));
+        rightBound[i] = before + 1 + postSamples;
+        if (rightBound[i] > channel -> length) {
+            rightBound[i] = channel -> length;
+        }
+        leftBound[i] = rightBound[i] - self.osc[oscIndex].windowSizeSamples[i];
+        if (leftBound[i] < channel_start(channel)) {
+            leftBound[i] = channel_start(channel);
+        }
+    }
+}
+
+/* freeze the window around a trigger point into the capture channels */
+void oscCapture(int oscIndex, trigger_point_t *point) {
+    int64_t leftBound[4];
+    int64_t rightBound[4];
+    oscTriggerBounds(oscIndex, point, leftBound, rightBound, self.osc[oscIndex].capturePhase);
+    for (int i = 0; i < 4; i++) {
+        channel_copy(self.osc[oscIndex].capture[i], self.data -> data[self.osc[oscIndex].dataIndex[i]].p, leftBound[i], rightBound[i]);
+        if (self.osc[oscIndex].captureMirror[i] != NULL) {
+            self.osc[oscIndex].captureMirror[i] -> channel = NULL; // contents changed under the same pointer, upload it again
+        }
+    }
+    self.osc[oscIndex].captured = 1;
+    self.freqRevision++;
+}
+
+/* channel a trigger condition looks at */
+int oscTriggerSource(int oscIndex, int condition) {
+    int source = self.osc[oscIndex].trigger.source[condition];
+    if (source <= 0 || source >= self.data -> length) {
+        return self.osc[oscIndex].dataIndex[self.osc[oscIndex].selectedChannel];
+    }
+    return source;
+}
+
+/* pop the next event of one condition's engine and time it, returns 0 if there are none */
+int oscTriggerNext(int oscIndex, int condition, trigger_point_t *point) {
+    trigger_event_t event;
+    while (trigger_pop(&self.osc[oscIndex].trigger.engine[condition], &event)) {
+        if (event.index < 1) {
+            continue;
+        }
+        point -> index = event.index;
+        point -> fraction = event.fraction;
+        point -> dataIndex = oscTriggerSource(oscIndex, condition);
+        /* event time is interpolated between the samples either side of it */
+        double beforeTime = sampleTime(point -> dataIndex, event.index - 1);
+        point -> time = beforeTime + event.fraction * (sampleTime(point -> dataIndex, event.index) - beforeTime);
+        return 1;
+    }
+    return 0;
+}
+
+/* find trigger events in every sample that arrived since the last call, called at ingest rather than per rendered frame
+each condition's engine scans its own source channel, with AND the second condition only qualifies the first (its source must be in its qualifying state at the event), with OR the events of both are taken in time order
+holdoff and timeout are measured in sample time
+an accepted event waits in trigger.pending until the post-trigger part of the window has arrived, then it is published in trigger.point (and captured in normal and single mode) */
+void oscTrigger(int oscIndex) {
+    for (int i = 0; i < 4; i++) {
+        self.osc[oscIndex].windowSizeSamples[i] = round((self.osc[oscIndex].windowSizeMicroseconds / 1000000) * ((logVariable_t *) self.logVariables -> data[self.osc[oscIndex].dataIndex[i]].p) -> samplesPerSecond);
+    }
+    if (self.osc[oscIndex].arm) {
+        self.osc[oscIndex].armed = 1;
+    }
+    trigger_settings_t *trigger = &self.osc[oscIndex].trigger;
+    int selected = self.osc[oscIndex].dataIndex[self.osc[oscIndex].selectedChannel];
+    channel_t *selectedChannel = self.data -> data[selected].p;
+    if (trigger -> type[0] == TRIGGER_NONE) {
+        trigger -> engineChannel[0] = NULL;
+        trigger -> engineChannel[1] = NULL;
+        trigger -> pending.index = 0;
+        trigger -> point.index = 0;
+        return;
+    }
+    /* the widget values become engine conditions, widths in samples of each source */
+    trigger_condition_t conditions[2];
+    for (int i = 0; i < 2; i++) {
+        double samplesPerSecond = ((logVariable_t *) self.logVariables -> data[oscTriggerSource(oscIndex, i)].p) -> samplesPerSecond;
+        conditions[i].type = trigger -> type[i];
+        conditions[i].level[0] = trigger -> threshold[i];
+        conditions[i].level[1] = trigger -> level2[i];
+        conditions[i].width[0] = trigger -> widthMinMicroseconds[i] / 1000000 * samplesPerSecond;
+        conditions[i].width[1] = trigger -> widthMaxMicroseconds[i] / 1000000 * samplesPerSecond;
+    }
+    int scanned = trigger -> logic == TRIGGER_LOGIC_OR && trigger -> type[1] != TRIGGER_NONE ? 2 : 1;
+    for (int i = 0; i < 2; i++) {
+        channel_t *source = self.data -> data[oscTriggerSource(oscIndex, i)].p;
+        if (i >= scanned) {
+            trigger -> engineChannel[i] = NULL;
+            continue;
+        }
+        if (trigger -> engineChannel[i] != source) {
+            trigger_init(&trigger -> engine[i], source);
+            trigger -> engineChannel[i] = source;
+            trigger -> pending.index = 0;
+            trigger -> point.index = 0;
+            trigger -> time = -DBL_MAX;
+        }
+        trigger_scan(&trigger -> engine[i], source, &conditions[i]);
+    }
+    int capturing = self.osc[oscIndex].mode == OSC_MODE_NORMAL || (self.osc[oscIndex].mode == OSC_MODE_SINGLE && self.osc[oscIndex].armed);
+    double postSeconds = self.osc[oscIndex].windowSizeMicroseconds / 1000000 * (1 - self.osc[oscIndex].preTrigger / 100);
+    double newest = sampleTime(selected, selectedChannel -> length - 1);
+    trigger_point_t next[2];
+    int waiting[2] = {0, 0};
+    for (int i = 0; i < scanned; i++) {
+        waiting[i] = oscTriggerNext(oscIndex, i, &next[i]);
+    }
+    while (1) {
+        /* publish once the window after the pending trigger is full */
+        if (trigger -> pending.index != 0 && newest >= trigger -> pending.time + postSeconds) {
+            trigger -> point = trigger -> pending;
+            trigger -> pending.index = 0;
+            if (capturing && !self.osc[oscIndex].stop) {
+                oscCapture(oscIndex, &trigger -> point);
+                if (self.osc[oscIndex].mode == OSC_MODE_SINGLE) {
+                    self.osc[oscIndex].armed = 0;
+                    capturing = 0;
+                }
+            }
+        }
+        /* oldest event of either condition */
+        int condition = -1;
+        for (int i = 0; i < scanned; i++) {
+            if (waiting[i] && (condition == -1 || next[i].time < next[condition].time)) {
+                condition = i;
+            }
+        }
+        if (condition == -1) {
+            break;
+        }
+        trigger_point_t event = next[condition];
+        waiting[condition] = oscTriggerNext(oscIndex, condition, &next[condition]);
+        if (trigger -> pending.index != 0 || (self.osc[oscIndex].mode == OSC_MODE_SINGLE && !capturing)) {
+            continue;
+        }
+        if (event.time < trigger -> time + trigger -> holdoffMicroseconds / 1000000) {
+            continue;
+        }
+        if (trigger -> logic == TRIGGER_LOGIC_AND && trigger -> type[1] != TRIGGER_NONE) {
+            int qualifier = oscTriggerSource(oscIndex, 1);
+            double qualifierIndex = floor(sampleIndexAtTime(qualifier, event.time) + 0.000001);
+            if (!trigger_qualify(&conditions[1], channel_get(self.data -> data[qualifier].p, qualifierIndex))) {
+                continue;
+            }
+        }
+        trigger -> pending = event;
+        trigger -> time = event.time;
+    }
+    if (trigger -> pending.index != 0 && trigger -> pending.index < channel_start(self.data -> data[trigger -> pending.dataIndex].p) + 1) {
+        trigger -> pending.index = 0;
+    }
+    if (trigger -> point.index != 0 && (trigger -> point.index < channel_start(self.data -> data[trigger -> point.dataIndex].p) + 1 || newest - trigger -> point.time > trigger -> timeoutMicroseconds / 1000000 + postSeconds)) {
+        trigger -> point.index = 0;
+    }
+}
+
+void triggerIngest() {
+    for (int i = 0; i < self.newOsc; i++) {
+        oscTrigger(i);
+    }
+}
+
+void renderOscData(int oscIndex) {
+    int windowIndex = ilog2(WINDOW_OSC) + oscIndex;
+    if (self.osc[oscIndex].oldSelectedChannel != self.osc[oscIndex].selectedChannel) {
+        self.osc[oscIndex].dummyOffset = (self.osc[oscIndex].topBound[self.osc[oscIndex].selectedChannel] + self.osc[oscIndex].bottomBound[self.osc[oscIndex].selectedChannel]) / -2;
+        if (fabs(self.osc[oscIndex].dummyOffset) < 0.01) {
+            self.osc[oscIndex].dummyOffset = 0;
+        }
+        self.osc[oscIndex].dummyTopBound = self.osc[oscIndex].topBound[self.osc[oscIndex].selectedChannel] + self.osc[oscIndex].dummyOffset;
+        self.osc[oscIndex].oldSelectedChannel = self.osc[oscIndex].selectedChannel;
+    }
+    self.osc[oscIndex].topBound[self.osc[oscIndex].selectedChannel] = self.osc[oscIndex].dummyTopBound - self.osc[oscIndex].dummyOffset;
+    self.osc[oscIndex].bottomBound[self.osc[oscIndex].selectedChannel] = self.osc[oscIndex].dummyTopBound * -1 - self.osc[oscIndex].dummyOffset;
+    /* set left and right bounds */
+    if (self.osc[oscIndex].mode != OSC_MODE_AUTO && self.osc[oscIndex].captured) {
+        /* show the whole frozen capture */
+        for (int i = 0; i < 4; i++) {
+            self.osc[oscIndex].leftBound[i] = channel_start(self.osc[oscIndex].capture[i]);
+            self.osc[oscIndex].rightBound[i] = self.osc[oscIndex].capture[i] -> length;
+            self.osc[oscIndex].phase[i] = self.osc[oscIndex].capturePhase[i];
+        }
+    } else if (!self.osc[oscIndex].stop) {
+        if (self.osc[oscIndex].trigger.point.index == 0) {
+            for (int i = 0; i < 4; i++) {
+                self.osc[oscIndex].phase[i] = 0;
+            }
+            setBoundsNoTrigger(oscIndex, 0);
+        } else {
+            /* trigger point was published by oscTrigger */
+            oscTriggerBounds(oscIndex, &self.osc[oscIndex].trigger.point, self.osc[oscIndex].leftBound, self.osc[oscIndex].rightBound, self.osc[oscIndex].phase);
+        }
+    } else {
+        setBoundsNoTrigger(oscIndex, 1);
+    }
+    if (self.windows[windowIndex].minimize == 0) {
+        /* render window background */
+        turtleRectangle(self.windows[windowIndex].windowCoords[0], self.windows[windowIndex].windowCoords[1], self.windows[windowIndex].windowCoords[2], self.windows[windowIndex].windowCoords[3], self.themeColors[self.theme + 12], self.themeColors[self.theme + 13], self.themeColors[self.theme + 14], 0);
+        turtlePenSize(1);
+        /* dashed line at the trigger level, and at the second level for banded triggers */
+        double triggerLevels[2] = {self.osc[oscIndex].trigger.threshold[0], self.osc[oscIndex].trigger.level2[0]};
+        for (int level = 0; level < 1 + trigger_banded(self.osc[oscIndex].trigger.type[0]); level++) {
+            double dashedY = self.windows[windowIndex].windowCoords[1] + (triggerLevels[level] - self.osc[oscIndex].bottomBound[self.osc[oscIndex].selectedChannel]) / (self.osc[oscIndex].topBound[self.osc[oscIndex].selectedChannel] - self.osc[oscIndex].bottomBound[self.osc[oscIndex].selectedChannel]) * (self.windows[windowIndex].windowCoords[3] - self.windows[windowIndex].windowTop - self.windows[windowIndex].windowCoords[1]);
+            if (dashedY < self.windows[windowIndex].windowCoords[3] - self.windows[windowIndex].windowTop && dashedY > self.windows[windowIndex].windowCoords[1]) {
+                turtlePenShape("none");
+                turtlePenColorAlpha(0, 0, 0, 200);
+                double dashedX = self.windows[windowIndex].windowCoords[0] + (self.windows[windowIndex].windowCoords[2] - self.windows[windowIndex].windowCoords[0]) / 40;
+                for (int i = 0; i < 20; i++) {
+                    turtleGoto(dashedX, dashedY);
+                    turtlePenDown();
+                    dashedX += (self.windows[windowIndex].windowCoords[2] - self.windows[windowIndex].windowCoords[0]) / 40;
+                    turtleGoto(dashedX, dashedY);
+                    turtlePenUp();
+                    dashedX += (self.windows[windowIndex].windowCoords[2] - self.windows[windowIndex].windowCoords[0]) / 40;
+                }
+            }
+        }
+        turtlePenColor(0, 0, 0);
+        turtlePenShape("circle");
+        turtleGoto(self.windows[windowIndex].windowCoords[0], (self.windows[windowIndex].windowCoords[1] - self.windows[windowIndex].windowTop + self.windows[windowIndex].windowCoords[3]) / 2);
+        turtlePenDown();
+        turtleGoto(self.windows[windowIndex].windowCoords[2], (self.windows[windowIndex].windowCoords[1] - self.windows[windowIndex].windowTop + self.windows[windowIndex].windowCoords[3]) / 2);
         turtlePenUp();
         /* render data */
         turtlePenSize(1);
@@ -1677,20 +2996,80 @@ void renderOscData(int oscIndex) {
                 continue;
             }
             turtlePenColor(self.themeColors[self.theme + 24 + j * 3], self.themeColors[self.theme + 25 + j * 3], self.themeColors[self.theme + 26 + j * 3]);
-            for (int i = 0; i < self.osc[oscIndex].rightBound[j] - self.osc[oscIndex].leftBound[j]; i++) {
-                turtleGoto(self.windows[windowIndex].windowCoords[0] + i * xquantum[j], self.windows[windowIndex].windowCoords[1] + ((self.data -> data[self.osc[oscIndex].dataIndex[j]].r -> data[self.osc[oscIndex].leftBound[j] + i].d - self.osc[oscIndex].bottomBound[j]) / (self.osc[oscIndex].topBound[j] - self.osc[oscIndex].bottomBound[j])) * (self.windows[windowIndex].windowCoords[3] - self.windows[windowIndex].windowTop - self.windows[windowIndex].windowCoords[1]));
-                turtlePenDown();
+            channel_t *channel = oscChannel(oscIndex, j);
+            double yscale = (self.windows[windowIndex].windowCoords[3] - self.windows[windowIndex].windowTop - self.windows[windowIndex].windowCoords[1]) / (self.osc[oscIndex].topBound[j] - self.osc[oscIndex].bottomBound[j]);
+            /* each pyramid bucket draws two points (min and max), so pick buckets about one pixel column wide */
+            double pixelsPerUnit = (double) turtle.screenbounds[0] / (turtle.bounds[2] - turtle.bounds[0]);
+            int level = channel_lod_level(channel, 1 / (xquantum[j] * pixelsPerUnit));
+            double traceLeft = self.windows[windowIndex].windowCoords[0] - self.osc[oscIndex].phase[j] * xquantum[j];
+            if (traceGLRender.enabled) {
+                /* the shader places vertex (sample offset, value) in the window */
+                double traceX = traceLeft;
+                double traceY = self.windows[windowIndex].windowCoords[1] - self.osc[oscIndex].bottomBound[j] * yscale;
+                double *traceColor = &self.themeColors[self.theme + 24 + j * 3];
+                /* raw samples come straight from the channel's GPU mirror where only new samples are uploaded, pyramid buckets are few enough to send every frame */
+                if (level > 0 || !traceGLMirrorDraw(oscMirror(oscIndex, j), channel, self.osc[oscIndex].leftBound[j], self.osc[oscIndex].rightBound[j], traceX, xquantum[j], traceY, yscale, traceColor[0], traceColor[1], traceColor[2], 1)) {
+                    traceGLBegin(traceX, xquantum[j], traceY, yscale, traceColor[0], traceColor[1], traceColor[2], 1);
+                    if (level == 0) {
+                        for (int i = 0; i < self.osc[oscIndex].rightBound[j] - self.osc[oscIndex].leftBound[j]; i++) {
+                            traceGLVertex(i, channel_get(channel, self.osc[oscIndex].leftBound[j] + i));
+                        }
+                    } else {
+                        int64_t bucketSize = channel_lod_size(level);
+                        int64_t lastOffset = self.osc[oscIndex].rightBound[j] - self.osc[oscIndex].leftBound[j] - 1;
+                        for (int64_t bucket = self.osc[oscIndex].leftBound[j] / bucketSize; bucket <= (self.osc[oscIndex].rightBound[j] - 1) / bucketSize; bucket++) {
+                            double bucketMin;
+                            double bucketMax;
+                            channel_lod_get(channel, level, bucket, &bucketMin, &bucketMax);
+                            int64_t bucketOffset = bucket * bucketSize + bucketSize / 2 - self.osc[oscIndex].leftBound[j];
+                            if (bucketOffset < 0) {
+                                bucketOffset = 0;
+                            }
+                            if (bucketOffset > lastOffset) {
+                                bucketOffset = lastOffset;
+                            }
+                            traceGLVertex(bucketOffset, bucketMin);
+                            traceGLVertex(bucketOffset, bucketMax);
+                        }
+                    }
+                    traceGLEnd();
+                }
+            } else if (level == 0) {
+                for (int i = 0; i < self.osc[oscIndex].rightBound[j] - self.osc[oscIndex].leftBound[j]; i++) {
+                    turtleGoto(traceLeft + i * xquantum[j], self.windows[windowIndex].windowCoords[1] + (channel_get(channel, self.osc[oscIndex].leftBound[j] + i) - self.osc[oscIndex].bottomBound[j]) * yscale);
+                    turtlePenDown();
+                }
+            } else {
+                int64_t bucketSize = channel_lod_size(level);
+                int64_t firstBucket = self.osc[oscIndex].leftBound[j] / bucketSize;
+                int64_t lastBucket = (self.osc[oscIndex].rightBound[j] - 1) / bucketSize;
+                for (int64_t bucket = firstBucket; bucket <= lastBucket; bucket++) {
+                    double bucketMin;
+                    double bucketMax;
+                    channel_lod_get(channel, level, bucket, &bucketMin, &bucketMax);
+                    double bucketX = traceLeft + (bucket * bucketSize + bucketSize / 2 - self.osc[oscIndex].leftBound[j]) * xquantum[j];
+                    if (bucketX < self.windows[windowIndex].windowCoords[0]) {
+                        bucketX = self.windows[windowIndex].windowCoords[0];
+                    }
+                    if (bucketX > self.windows[windowIndex].windowCoords[2]) {
+                        bucketX = self.windows[windowIndex].windowCoords[2];
+                    }
+                    turtleGoto(bucketX, self.windows[windowIndex].windowCoords[1] + (bucketMin - self.osc[oscIndex].bottomBound[j]) * yscale);
+                    turtlePenDown();
+                    turtleGoto(bucketX, self.windows[windowIndex].windowCoords[1] + (bucketMax - self.osc[oscIndex].bottomBound[j]) * yscale);
+                }
             }
             turtlePenUp();
         }
         /* render mouse */
         if (self.mx > self.windows[windowIndex].windowCoords[0] + 15 && self.my > self.windows[windowIndex].windowCoords[1] && self.mx < self.windows[windowIndex].windowCoords[2] && self.windows[windowIndex].windowCoords[3] - self.windows[windowIndex].windowTop) { // unintentional forgot "self.my <" but i prefer it this way
-            int sample = round((self.mx - self.windows[windowIndex].windowCoords[0]) / xquantum[self.osc[oscIndex].selectedChannel]);
-            if (self.osc[oscIndex].leftBound[self.osc[oscIndex].selectedChannel] + sample >= self.data -> data[self.osc[oscIndex].dataIndex[self.osc[oscIndex].selectedChannel]].r -> length) {
+            double sampleLeft = self.windows[windowIndex].windowCoords[0] - self.osc[oscIndex].phase[self.osc[oscIndex].selectedChannel] * xquantum[self.osc[oscIndex].selectedChannel];
+            int sample = round((self.mx - sampleLeft) / xquantum[self.osc[oscIndex].selectedChannel]);
+            if (self.osc[oscIndex].leftBound[self.osc[oscIndex].selectedChannel] + sample >= oscChannel(oscIndex, self.osc[oscIndex].selectedChannel) -> length) {
                 goto OSC_SIDE_AXIS; // skip this section
             }
-            double sampleX = self.windows[windowIndex].windowCoords[0] + sample * xquantum[self.osc[oscIndex].selectedChannel];
-            double sampleY = self.windows[windowIndex].windowCoords[1] + ((self.data -> data[self.osc[oscIndex].dataIndex[self.osc[oscIndex].selectedChannel]].r -> data[self.osc[oscIndex].leftBound[self.osc[oscIndex].selectedChannel] + sample].d - self.osc[oscIndex].bottomBound[self.osc[oscIndex].selectedChannel]) / (self.osc[oscIndex].topBound[self.osc[oscIndex].selectedChannel] - self.osc[oscIndex].bottomBound[self.osc[oscIndex].selectedChannel])) * (self.windows[windowIndex].windowCoords[3] - self.windows[windowIndex].windowTop - self.windows[windowIndex].windowCoords[1]);
+            double sampleX = sampleLeft + sample * xquantum[self.osc[oscIndex].selectedChannel];
+            double sampleY = self.windows[windowIndex].windowCoords[1] + ((channel_get(oscChannel(oscIndex, self.osc[oscIndex].selectedChannel), self.osc[oscIndex].leftBound[self.osc[oscIndex].selectedChannel] + sample) - self.osc[oscIndex].bottomBound[self.osc[oscIndex].selectedChannel]) / (self.osc[oscIndex].topBound[self.osc[oscIndex].selectedChannel] - self.osc[oscIndex].bottomBound[self.osc[oscIndex].selectedChannel])) * (self.windows[windowIndex].windowCoords[3] - self.windows[windowIndex].windowTop - self.windows[windowIndex].windowCoords[1]);
             turtleRectangle(sampleX - 1, self.windows[windowIndex].windowCoords[3] - self.windows[windowIndex].windowTop, sampleX + 1, self.windows[windowIndex].windowCoords[1], self.themeColors[self.theme + 21], self.themeColors[self.theme + 22], self.themeColors[self.theme + 23], 100);
             turtleRectangle(self.windows[windowIndex].windowCoords[0], sampleY - 1, self.windows[windowIndex].windowCoords[2], sampleY + 1, self.themeColors[self.theme + 21], self.themeColors[self.theme + 22], self.themeColors[self.theme + 23], 100);
             turtlePenColor(215, 215, 215);
@@ -1700,7 +3079,7 @@ void renderOscData(int oscIndex) {
             turtlePenUp();
             char sampleValue[24];
             /* render side box */
-            sprintf(sampleValue, "%.02lf", self.data -> data[self.osc[oscIndex].dataIndex[self.osc[oscIndex].selectedChannel]].r -> data[self.osc[oscIndex].leftBound[self.osc[oscIndex].selectedChannel] + sample].d);
+            sprintf(sampleValue, "%.02lf", channel_get(oscChannel(oscIndex, self.osc[oscIndex].selectedChannel), self.osc[oscIndex].leftBound[self.osc[oscIndex].selectedChannel] + sample));
             double boxLength = textGLGetStringLength(sampleValue, 8);
             double boxX = self.windows[windowIndex].windowCoords[0] + 12;
             if (sampleX - boxX < 40) {
@@ -1772,66 +3151,271 @@ void renderOscData(int oscIndex) {
     }
 }
 
+/* FFT length for a segment of the osc window, zero padding it up to a length kissFFT factors well (the real transform also needs it even)
+a fixed N is independent of the window */
+int freqFftLength(int64_t segment) {
+    if (self.freqLengthMode >= FREQ_LENGTH_FIXED) {
+        return freqFixedLengths[self.freqLengthMode - FREQ_LENGTH_FIXED];
+    }
+    if (self.freqLengthMode == FREQ_LENGTH_POW2) {
+        int length = 2;
+        while (length < segment) {
+            length *= 2;
+        }
+        return length;
+    }
+    return kiss_fftr_next_fast_size_real(segment);
+}
+
+/* hand freqRequest[0] to the worker, fails if the worker holds the lock
+with queued set it also fails while the worker has not taken the previous request, so averaged blocks are never replaced before they are used */
+int freqSubmit(int queued) {
+    if (pthread_mutex_trylock(&self.freqLock) != 0) {
+        return 0;
+    }
+    if (queued && self.freqRequestWaiting) {
+        pthread_mutex_unlock(&self.freqLock);
+        return 0;
+    }
+    freq_request_t filled = self.freqRequest[0];
+    self.freqRequest[0] = self.freqRequest[1];
+    self.freqRequest[1] = filled;
+    self.freqRequestWaiting = 1;
+    pthread_cond_signal(&self.freqSignal);
+    pthread_mutex_unlock(&self.freqLock);
+    return 1;
+}
+
+/* osc channels the frequency view transforms, the selected one first and in overlay mode every other channel with a source */
+int freqChannels(int *channels) {
+    int inputs = 0;
+    channels[inputs++] = self.freqOscChannel;
+    if (self.freqAllChannels) {
+        for (int i = 0; i < 4; i++) {
+            if (i != self.freqOscChannel && self.osc[self.freqOscIndex].dataIndex[i] > 0) {
+                channels[inputs++] = i;
+            }
+        }
+    }
+    return inputs;
+}
+
+/* averaged mode - hands the workers every sample of the live channels that completes a segment since the last hand-off
+the first block starts one segment back, and if the workers fall more than FREQ_MAX_SEGMENTS behind on a channel its oldest segments are skipped */
+void freqExchangeAveraged() {
+    int channels[FREQ_CHANNELS];
+    int inputs = freqChannels(channels);
+    int fftLength = freqFftLength(self.osc[self.freqOscIndex].windowSizeSamples[self.freqOscChannel]);
+    int hop = round(fftLength * (1 - self.freqOverlap / 100));
+    if (hop < 1) {
+        hop = 1;
+    }
+    int averages = round(self.freqAverages);
+    int restart = inputs != self.welchInputs || fftLength != self.welchLength || self.freqWindowMode != self.welchWindow || self.freqAverageMode != self.welchAverage || averages != self.welchAverages || self.freqReset;
+    for (int i = 0; i < inputs && restart == 0; i++) {
+        restart = self.data -> data[self.osc[self.freqOscIndex].dataIndex[channels[i]]].p != self.welchChannel[i];
+    }
+    if (restart) {
+        self.welchInputs = inputs;
+        self.welchLength = fftLength;
+        self.welchWindow = self.freqWindowMode;
+        self.welchAverage = self.freqAverageMode;
+        self.welchAverages = averages;
+        for (int i = 0; i < inputs; i++) {
+            self.welchChannel[i] = self.data -> data[self.osc[self.freqOscIndex].dataIndex[channels[i]]].p;
+            self.welchNext[i] = self.welchChannel[i] -> length - fftLength;
+        }
+        self.welchReset = 1;
+    }
+    freq_request_t *request = &self.freqRequest[0];
+    int64_t segments[FREQ_CHANNELS];
+    int64_t totalSegments = 0;
+    for (int i = 0; i < inputs; i++) {
+        channel_t *channel = self.welchChannel[i];
+        if (self.welchNext[i] < channel_start(channel)) {
+            self.welchNext[i] = channel_start(channel); // overwritten before it was transformed
+        }
+        segments[i] = 0;
+        if (channel -> length - self.welchNext[i] >= fftLength) {
+            segments[i] = (channel -> length - self.welchNext[i] - fftLength) / hop + 1;
+        }
+        if (segments[i] > FREQ_MAX_SEGMENTS) {
+            self.welchNext[i] += (segments[i] - FREQ_MAX_SEGMENTS) * hop;
+            segments[i] = FREQ_MAX_SEGMENTS;
+        }
+        totalSegments += segments[i];
+    }
+    if (totalSegments == 0) {
+        return;
+    }
+    for (int i = 0; i < inputs; i++) {
+        freq_input_t *input = &request -> input[i];
+        input -> length = segments[i] > 0 ? (segments[i] - 1) * hop + fftLength : 0;
+        input -> channel = channels[i];
+        input -> samplesPerSecond = ((logVariable_t *) self.logVariables -> data[self.osc[self.freqOscIndex].dataIndex[channels[i]]].p) -> samplesPerSecond;
+        float *samples = spectrum_reserve(&input -> samples, sizeof(float) * input -> length);
+        for (int j = 0; j < input -> length; j++) {
+            samples[j] = channel_get(self.welchChannel[i], self.welchNext[i] + j);
+        }
+    }
+    request -> inputs = inputs;
+    request -> fftLength = fftLength;
+    request -> hop = hop;
+    request -> window = self.freqWindowMode;
+    request -> average = self.freqAverageMode;
+    request -> averages = averages;
+    request -> reset = self.welchReset;
+    if (freqSubmit(1)) {
+        for (int i = 0; i < inputs; i++) {
+            self.welchNext[i] += segments[i] * hop;
+        }
+        self.welchReset = 0;
+    }
+}
+
+/* called on the render thread - copies the segments under the frequency view for the workers when their sources, bounds or contents changed, and picks up finished spectra
+neither step waits on the workers, if they hold the lock the hand-off is retried next frame */
+void freqExchange() {
+    if (self.freqAverageMode != FREQ_AVERAGE_OFF) {
+        freqExchangeAveraged();
+        self.freqSubmittedInputs = 0; // single shot transforms again when averaging is turned off
+    } else {
+        self.welchInputs = 0;
+        int channels[FREQ_CHANNELS];
+        int inputs = freqChannels(channels);
+        int64_t right = self.osc[self.freqOscIndex].rightBound[self.freqOscChannel];
+        int64_t length = right - self.osc[self.freqOscIndex].leftBound[self.freqOscChannel];
+        int fftLength = freqFftLength(length);
+        if (self.freqLengthMode >= FREQ_LENGTH_FIXED) {
+            /* the last N samples, or as many as the selected channel still holds */
+            int64_t start = channel_start(oscChannel(self.freqOscIndex, self.freqOscChannel));
+            length = right - start < fftLength ? right - start : fftLength;
+        }
+        /* every channel gets the selected channel's number of samples ending at its own right bound, so they share one window and plan */
+        channel_t *sources[FREQ_CHANNELS];
+        int64_t left[FREQ_CHANNELS];
+        int64_t rights[FREQ_CHANNELS];
+        int sourceChannels[FREQ_CHANNELS];
+        int valid = 0;
+        for (int i = 0; i < inputs; i++) {
+            channel_t *channel = oscChannel(self.freqOscIndex, channels[i]);
+            int64_t channelRight = self.osc[self.freqOscIndex].rightBound[channels[i]];
+            int64_t channelLeft = channelRight - length;
+            if (length < 2 || channelLeft < channel_start(channel) || channelRight > channel -> length) {
+                if (i == 0) {
+                    break; // nothing to show without the selected channel
+                }
+                continue;
+            }
+            sources[valid] = channel;
+            left[valid] = channelLeft;
+            rights[valid] = channelRight;
+            sourceChannels[valid] = channels[i];
+            valid++;
+        }
+        int changed = valid != self.freqSubmittedInputs || fftLength != self.freqSubmittedLength || self.freqWindowMode != self.freqSubmittedWindow || self.freqRevision != self.freqSubmittedRevision;
+        for (int i = 0; i < valid && changed == 0; i++) {
+            changed = sources[i] != self.freqChannel[i] || left[i] != self.freqLeft[i] || rights[i] != self.freqRight[i];
+        }
+        if (changed && valid > 0) {
+            freq_request_t *request = &self.freqRequest[0];
+            for (int i = 0; i < valid; i++) {
+                freq_input_t *input = &request -> input[i];
+                input -> length = length;
+                input -> channel = sourceChannels[i];
+                input -> samplesPerSecond = ((logVariable_t *) self.logVariables -> data[self.osc[self.freqOscIndex].dataIndex[sourceChannels[i]]].p) -> samplesPerSecond;
+                float *samples = spectrum_reserve(&input -> samples, sizeof(float) * length);
+                for (int j = 0; j < length; j++) {
+                    samples[j] = channel_get(sources[i], left[i] + j);
+                }
+            }
+            request -> inputs = valid;
+            request -> fftLength = fftLength;
+            request -> hop = 0;
+            request -> window = self.freqWindowMode;
+            request -> average = FREQ_AVERAGE_OFF;
+            request -> averages = 1;
+            request -> reset = 1;
+            if (freqSubmit(0)) {
+                for (int i = 0; i < valid; i++) {
+                    self.freqChannel[i] = sources[i];
+                    self.freqLeft[i] = left[i];
+                    self.freqRight[i] = rights[i];
+                }
+                self.freqSubmittedInputs = valid;
+                self.freqSubmittedLength = fftLength;
+                self.freqSubmittedWindow = self.freqWindowMode;
+                self.freqSubmittedRevision = self.freqRevision;
+            }
+        }
+    }
+    if (pthread_mutex_trylock(&self.freqLock) == 0) {
+        if (self.freqSpectrumReady) {
+            freq_spectra_t spectra = self.freqSpectra[0];
+            self.freqSpectra[0] = self.freqSpectra[1];
+            self.freqSpectra[1] = spectra;
+            self.freqSpectrumReady = 0;
+            pthread_cond_signal(&self.freqSignal);
+        }
+        pthread_mutex_unlock(&self.freqLock);
+    }
+}
+
 void renderFreqData() {
     int windowIndex = ilog2(WINDOW_FREQ);
     int sideAxisWidth = 10;
     int bottomAxisHeight = 10;
-    /* linear windowing function over 10% of the sample */
+    freqExchange();
+    freq_spectra_t *spectra = &self.freqSpectra[0];
+    freq_spectrum_t *spectrum = &spectra -> spectrum[0]; // selected channel, the axes and readout follow it
     int dataLength = self.osc[self.freqOscIndex].rightBound[self.freqOscChannel] - self.osc[self.freqOscIndex].leftBound[self.freqOscChannel];
-    int threshold = (dataLength) * 0.1;
-    double damping = 1.0 / threshold;
-    list_clear(self.windowData);
-    if (self.data -> data[self.osc[self.freqOscIndex].dataIndex[self.freqOscChannel]].r -> length < self.osc[self.freqOscIndex].rightBound[self.freqOscChannel]) {
+    if (dataLength < 2 || spectra -> count == 0 || spectrum -> bins < 2 || oscChannel(self.freqOscIndex, self.freqOscChannel) -> length < self.osc[self.freqOscIndex].rightBound[self.freqOscChannel]) {
         turtleRectangle(self.windows[windowIndex].windowCoords[0], self.windows[windowIndex].windowCoords[1], self.windows[windowIndex].windowCoords[2], self.windows[windowIndex].windowCoords[3], self.themeColors[self.theme + 12], self.themeColors[self.theme + 13], self.themeColors[self.theme + 14], 0);
         return;
     }
-    for (int i = 0; i < dataLength; i++) {
-        double dataPoint = self.data -> data[self.osc[self.freqOscIndex].dataIndex[self.freqOscChannel]].r -> data[i + self.osc[self.freqOscIndex].leftBound[self.freqOscChannel]].d;
-        if (i < threshold) {
-            dataPoint *= damping * (i + 1);
-        }
-        if (i >= (dataLength) - threshold) {
-            dataPoint *= damping * ((dataLength) - (i - 1));
-        }
-        list_append(self.windowData, (unitype) dataPoint, 'd');
-    }
-    list_clear(self.freqData);
-    list_clear(self.phaseData);
-    fft_list_wrapper(self.windowData, self.freqData, self.phaseData);
-    double xquantum = (self.windows[windowIndex].windowCoords[2] - self.windows[windowIndex].windowCoords[0] - self.windows[windowIndex].windowSide - sideAxisWidth) / ((self.windowData -> length - 2) / self.freqZoom) * 2;
+    double xquantum = (self.windows[windowIndex].windowCoords[2] - self.windows[windowIndex].windowCoords[0] - self.windows[windowIndex].windowSide - sideAxisWidth) / ((spectrum -> bins - 1) / self.freqZoom);
     if (self.windows[windowIndex].minimize == 0) {
         /* render window background */
         turtleRectangle(self.windows[windowIndex].windowCoords[0], self.windows[windowIndex].windowCoords[1], self.windows[windowIndex].windowCoords[2], self.windows[windowIndex].windowCoords[3], self.themeColors[self.theme + 12], self.themeColors[self.theme + 13], self.themeColors[self.theme + 14], 0);
         turtlePenSize(1);
         /* render frequency data */
-        turtlePenColor(self.themeColors[self.theme + 24 + self.freqOscChannel * 3], self.themeColors[self.theme + 25 + self.freqOscChannel * 3], self.themeColors[self.theme + 26 + self.freqOscChannel * 3]);
-        if (self.freqData -> length % 2) {
-            xquantum *= (self.freqData -> length - 2.0) / (self.freqData -> length - 1.0);
-        }
         self.freqRightBound = 1 + self.freqLeftBound + (self.windows[windowIndex].windowCoords[2] - self.windows[windowIndex].windowSide - self.windows[windowIndex].windowCoords[0]) / xquantum;
-        if (self.freqRightBound > self.freqData -> length / 2 + self.freqData -> length % 2) {
-            self.freqRightBound = self.freqData -> length / 2 + self.freqData -> length % 2;
+        if (self.freqRightBound > spectrum -> bins) {
+            self.freqRightBound = spectrum -> bins;
         }
-        for (int i = self.freqLeftBound; i < self.freqRightBound; i++) { // only render the bottom half of frequency graph
-            double magnitude = self.freqData -> data[i].d;
-            if (magnitude < 0) {
-                magnitude *= -1;
+        /* overlaid channels first so the selected one is on top, their bins are placed by frequency on the selected channel's bin axis */
+        double binWidth = spectrum -> samplesPerSecond / spectrum -> fftLength;
+        for (int j = spectra -> count - 1; j >= 0; j--) {
+            freq_spectrum_t *trace = &spectra -> spectrum[j];
+            double scale = trace -> samplesPerSecond / trace -> fftLength / binWidth;
+            int first = ceil(self.freqLeftBound / scale);
+            int last = ceil(self.freqRightBound / scale);
+            if (last > trace -> bins) {
+                last = trace -> bins;
             }
-            turtleGoto(sideAxisWidth + self.windows[windowIndex].windowCoords[0] + (i - self.freqLeftBound) * xquantum, self.windows[windowIndex].windowCoords[1] + bottomAxisHeight + ((magnitude - 0) / (self.topFreq - 0)) * (self.windows[windowIndex].windowCoords[3] - self.windows[windowIndex].windowTop - self.windows[windowIndex].windowCoords[1]));
-            turtlePenDown();
+            float *magnitudes = trace -> magnitude.data;
+            turtlePenColor(self.themeColors[self.theme + 24 + trace -> channel * 3], self.themeColors[self.theme + 25 + trace -> channel * 3], self.themeColors[self.theme + 26 + trace -> channel * 3]);
+            for (int i = first; i < last; i++) {
+                double magnitude = magnitudes[i];
+                if (magnitude < 0) {
+                    magnitude *= -1;
+                }
+                turtleGoto(sideAxisWidth + self.windows[windowIndex].windowCoords[0] + (i * scale - self.freqLeftBound) * xquantum, self.windows[windowIndex].windowCoords[1] + bottomAxisHeight + ((magnitude - 0) / (self.topFreq - 0)) * (self.windows[windowIndex].windowCoords[3] - self.windows[windowIndex].windowTop - self.windows[windowIndex].windowCoords[1]));
+                turtlePenDown();
+            }
+            turtlePenUp();
         }
-        turtlePenUp();
         /* render phase data */
         // turtlePenColor(self.themeColors[self.theme + 36], self.themeColors[self.theme + 37], self.themeColors[self.theme + 38]);
-        // if (self.phaseData -> length % 2) {
-        //     xquantum *= (self.phaseData -> length - 2.0) / (self.phaseData -> length - 1.0);
+        // if (spectrum -> phase -> length % 2) {
+        //     xquantum *= (spectrum -> phase -> length - 2.0) / (spectrum -> phase -> length - 1.0);
         // }
         // self.freqRightBound = 1 + self.freqLeftBound + (self.windows[windowIndex].windowCoords[2] - self.windows[windowIndex].windowSide - self.windows[windowIndex].windowCoords[0]) / xquantum;
-        // if (self.freqRightBound > self.phaseData -> length / 2 + self.phaseData -> length % 2) {
-        //     self.freqRightBound = self.phaseData -> length / 2 + self.phaseData -> length % 2;
+        // if (self.freqRightBound > spectrum -> phase -> length / 2 + spectrum -> phase -> length % 2) {
+        //     self.freqRightBound = spectrum -> phase -> length / 2 + spectrum -> phase -> length % 2;
         // }
         // for (int i = self.freqLeftBound; i < self.freqRightBound; i++) {
-        //     double magnitude = self.phaseData -> data[i].d;
+        //     double magnitude = spectrum -> phase -> data[i].d;
         //     turtleGoto(self.windows[windowIndex].windowCoords[0] + (i - self.freqLeftBound) * xquantum, (self.windows[windowIndex].windowCoords[1] + self.windows[windowIndex].windowCoords[3] - self.windows[windowIndex].windowTop) / 2 + ((magnitude - 0) / (self.topFreq - 0)) * (self.windows[windowIndex].windowCoords[3] - self.windows[windowIndex].windowTop - self.windows[windowIndex].windowCoords[1]));
         //     turtlePenDown();
         // }
@@ -1840,12 +3424,12 @@ void renderFreqData() {
         /* render mouse */
         if (self.mx > self.windows[windowIndex].windowCoords[0] + sideAxisWidth && self.my > self.windows[windowIndex].windowCoords[1] + bottomAxisHeight && self.mx < self.windows[windowIndex].windowCoords[2] - self.windows[windowIndex].windowSide && self.windows[windowIndex].windowCoords[3] - self.windows[windowIndex].windowTop) {
             double sample = (self.mx - self.windows[windowIndex].windowCoords[0] - sideAxisWidth) / xquantum + self.freqLeftBound;
-            if (self.osc[self.freqOscIndex].leftBound[self.freqOscChannel] + sample >= self.data -> data[self.osc[self.freqOscIndex].dataIndex[self.freqOscChannel]].r -> length) {
+            int roundedSample = round(sample);
+            if (roundedSample < 0 || roundedSample >= spectrum -> bins) {
                 goto FREQ_SIDE_AXIS;
             }
-            int roundedSample = round(sample);
             double sampleX = sideAxisWidth + self.windows[windowIndex].windowCoords[0] + (roundedSample - self.freqLeftBound) * xquantum;
-            double sampleY = bottomAxisHeight + self.windows[windowIndex].windowCoords[1] + (fabs(self.freqData -> data[roundedSample].d) / (self.topFreq)) * (self.windows[windowIndex].windowCoords[3] - self.windows[windowIndex].windowTop - self.windows[windowIndex].windowCoords[1]);
+            double sampleY = bottomAxisHeight + self.windows[windowIndex].windowCoords[1] + (fabs(((float *) spectrum -> magnitude.data)[roundedSample]) / (self.topFreq)) * (self.windows[windowIndex].windowCoords[3] - self.windows[windowIndex].windowTop - self.windows[windowIndex].windowCoords[1]);
             turtleRectangle(sampleX - 1, self.windows[windowIndex].windowCoords[3] - self.windows[windowIndex].windowTop, sampleX + 1, self.windows[windowIndex].windowCoords[1], self.themeColors[self.theme + 21], self.themeColors[self.theme + 22], self.themeColors[self.theme + 23], 100);
             turtleRectangle(self.windows[windowIndex].windowCoords[0], sampleY - 1, self.windows[windowIndex].windowCoords[2] - self.windows[windowIndex].windowSide, sampleY + 1, self.themeColors[self.theme + 21], self.themeColors[self.theme + 22], self.themeColors[self.theme + 23], 100);
             turtlePenColor(215, 215, 215);
@@ -1855,7 +3439,7 @@ void renderFreqData() {
             turtlePenUp();
             char sampleValue[24];
             /* render side box */
-            sprintf(sampleValue, "%.02lf", fabs(self.freqData -> data[roundedSample].d));
+            sprintf(sampleValue, "%.02lf", fabs(((float *) spectrum -> magnitude.data)[roundedSample]));
             double boxLength = textGLGetStringLength(sampleValue, 8);
             double boxX = self.windows[windowIndex].windowCoords[0] + 2;
             if (sampleX - boxX < 40) {
@@ -1866,8 +3450,7 @@ void renderFreqData() {
             turtlePenColor(0, 0, 0);
             textGLWriteString(sampleValue, boxX + 2, boxY - 1, 8, 0);
             /* render top box */
-            double samplesPerSecond = self.data -> data[self.osc[self.freqOscIndex].dataIndex[self.freqOscChannel]].r -> data[0].d;
-            sprintf(sampleValue, "%.1lfHz", sample / (dataLength / samplesPerSecond));
+            sprintf(sampleValue, "%.1lfHz", sample * spectrum -> samplesPerSecond / spectrum -> fftLength);
             double boxLength2 = textGLGetStringLength(sampleValue, 8);
             double boxX2 = sampleX - boxLength2 / 2;
             if (boxX2 - 5 < self.windows[windowIndex].windowCoords[0]) {
@@ -1986,7 +3569,8 @@ void renderFreqData() {
             if (self.my > self.windows[windowIndex].windowCoords[1] && self.my < self.windows[windowIndex].windowCoords[1] + 15) {
                 turtleTriangle(xpos, self.windows[windowIndex].windowCoords[1] + tickLength + 2, xpos + 6, self.windows[windowIndex].windowCoords[1] + tickLength + 10, xpos - 6, self.windows[windowIndex].windowCoords[1] + tickLength + 10, 215, 215, 215, 0);
                 char tickValue[24];
-                sprintf(tickValue, "%dHz", (int) ((double) (self.freqRightBound - self.freqLeftBound) / tickMarks * mouseSample));
+                double bin = self.freqLeftBound + (double) (self.freqRightBound - self.freqLeftBound) / tickMarks * mouseSample;
+                sprintf(tickValue, "%dHz", (int) (bin * spectrum -> samplesPerSecond / spectrum -> fftLength));
                 turtlePenColor(215, 215, 215);
                 textGLWriteString(tickValue, xpos, self.windows[windowIndex].windowCoords[1] + tickLength + 17, 8, 50);
             }
@@ -1994,6 +3578,432 @@ void renderFreqData() {
     }
 }
 
+/* 256 entry RGB table for a spectrogram colormap, interpolated between evenly spaced stops */
+void spectrogramColors(int colormap, unsigned char *rgb) {
+    const unsigned char viridis[] = {68, 1, 84, 59, 82, 139, 33, 145, 140, 94, 201, 98, 253, 231, 37};
+    const unsigned char inferno[] = {0, 0, 4, 66, 10, 104, 147, 38, 103, 221, 81, 58, 252, 165, 10, 252, 255, 164};
+    const unsigned char gray[] = {0, 0, 0, 255, 255, 255};
+    const unsigned char jet[] = {0, 0, 127, 0, 0, 255, 0, 255, 255, 255, 255, 0, 255, 0, 0, 127, 0, 0};
+    const unsigned char *stops[] = {viridis, inferno, gray, jet};
+    const int numStops[] = {5, 6, 2, 6};
+    for (int i = 0; i < 256; i++) {
+        double position = i / 255.0 * (numStops[colormap] - 1);
+        int stop = position;
+        if (stop >= numStops[colormap] - 1) {
+            stop = numStops[colormap] - 2;
+        }
+        double fraction = position - stop;
+        for (int j = 0; j < 3; j++) {
+            rgb[i * 3 + j] = round(stops[colormap][stop * 3 + j] * (1 - fraction) + stops[colormap][stop * 3 + 3 + j] * fraction);
+        }
+    }
+}
+
+/* restart the STFT, called when the channel, FFT size, hop or window changes */
+void spectrogramReset(channel_t *channel, int size, int hop) {
+    spectrogram_t *spectrogram = &self.spectrogram;
+    int rows = size / 2 + 1;
+    spectrogram -> channel = channel;
+    spectrogram -> size = size;
+    spectrogram -> hop = hop;
+    spectrogram -> windowType = spectrogram -> window;
+    spectrogram -> windowSum = spectrum_window(spectrum_reserve(&spectrogram -> coefficients, sizeof(float) * size), size, spectrogram -> window);
+    spectrogram -> next = channel -> length - size; // first column straight away if the channel holds enough
+    spectrogram -> columns = 0;
+    float *history = spectrum_reserve(&spectrogram -> history, sizeof(float) * rows * SPECTROGRAM_HISTORY);
+    for (int i = 0; i < rows * SPECTROGRAM_HISTORY; i++) {
+        history[i] = TRACEGL_IMAGE_EMPTY;
+    }
+    if (traceGLRender.enabled) {
+        if (spectrogram -> image != NULL && spectrogram -> image -> rows != rows) {
+            traceGLImageFree(spectrogram -> image);
+            spectrogram -> image = NULL;
+        }
+        if (spectrogram -> image == NULL) {
+            spectrogram -> image = traceGLImageInit(rows, SPECTROGRAM_HISTORY);
+            spectrogram -> appliedColormap = -1;
+        } else {
+            traceGLImageClear(spectrogram -> image);
+        }
+    }
+}
+
+/* called once per frame on the render thread - transforms every column the channel has completed since the last frame and appends them to the image
+at most SPECTROGRAM_MAX_COLUMNS columns are transformed per frame, if the STFT falls further behind the oldest ones are skipped */
+void spectrogramUpdate() {
+    spectrogram_t *spectrogram = &self.spectrogram;
+    if (spectrogram -> dataIndex >= self.data -> length) {
+        spectrogram -> dataIndex = 0;
+    }
+    channel_t *channel = self.data -> data[spectrogram -> dataIndex].p;
+    int size = spectrogramSizes[spectrogram -> sizeIndex];
+    int hop = size / spectrogramHops[spectrogram -> hopIndex];
+    int rows = size / 2 + 1;
+    spectrogram -> samplesPerSecond = ((logVariable_t *) self.logVariables -> data[spectrogram -> dataIndex].p) -> samplesPerSecond;
+    if (channel != spectrogram -> channel || size != spectrogram -> size || hop != spectrogram -> hop || spectrogram -> window != spectrogram -> windowType) {
+        spectrogramReset(channel, size, hop);
+    }
+    if (spectrogram -> image != NULL && spectrogram -> colormap != spectrogram -> appliedColormap) {
+        unsigned char rgb[256 * 3];
+        spectrogramColors(spectrogram -> colormap, rgb);
+        traceGLImageColormap(spectrogram -> image, rgb);
+        spectrogram -> appliedColormap = spectrogram -> colormap;
+    }
+    if (spectrogram -> next < channel_start(channel)) {
+        spectrogram -> next = channel_start(channel);
+    }
+    if (channel -> length - spectrogram -> next < size) {
+        return;
+    }
+    int64_t count = (channel -> length - spectrogram -> next - size) / hop + 1;
+    if (count > SPECTROGRAM_MAX_COLUMNS) {
+        spectrogram -> next += (count - SPECTROGRAM_MAX_COLUMNS) * hop;
+        count = SPECTROGRAM_MAX_COLUMNS;
+    }
+    float *coefficients = spectrogram -> coefficients.data;
+    int64_t blockLength = (count - 1) * hop + size;
+    float *block = spectrum_reserve(&spectrogram -> block, sizeof(float) * blockLength);
+    kiss_fft_scalar *segment = spectrum_reserve(&spectrogram -> segment, sizeof(kiss_fft_scalar) * size);
+    kiss_fft_cpx *bins = spectrum_reserve(&spectrogram -> bins, sizeof(kiss_fft_cpx) * rows);
+    kiss_fft_cpx *work = spectrum_reserve(&spectrogram -> work, sizeof(kiss_fft_cpx) * (size / 2));
+    float *power = spectrum_reserve(&spectrogram -> power, sizeof(float) * rows * SPECTRUM_LANES);
+    float *columns = spectrum_reserve(&spectrogram -> pending, sizeof(float) * rows * count);
+    float *history = spectrogram -> history.data;
+    for (int64_t i = 0; i < blockLength; i++) {
+        block[i] = channel_get(channel, spectrogram -> next + i);
+    }
+    spectrum_plan_t *plan = spectrum_plan(size);
+    /* consecutive columns go in the lanes of one transform */
+    for (int column = 0; column < count; column += SPECTRUM_LANES) {
+        const float *signals[SPECTRUM_LANES];
+        int lanes = count - column < SPECTRUM_LANES ? count - column : SPECTRUM_LANES;
+        for (int k = 0; k < lanes; k++) {
+            signals[k] = block + (int64_t) (column + k) * hop;
+        }
+        spectrum_load(segment, signals, lanes, coefficients, size, size);
+        spectrum_rfft(plan, segment, bins, work);
+        spectrum_power(power, bins, rows);
+        for (int k = 0; k < lanes; k++) {
+            float *values = columns + (int64_t) (column + k) * rows;
+            for (int i = 0; i < rows; i++) {
+                /* amplitude in dB, a sinusoid of amplitude A lands in its bin with magnitude A * windowSum / 2 */
+                double amplitude = sqrt(power[i * SPECTRUM_LANES + k]) * 2 / spectrogram -> windowSum;
+                values[i] = 20 * log10(amplitude + 1E-12);
+            }
+            memcpy(history + (spectrogram -> columns % SPECTROGRAM_HISTORY) * rows, values, sizeof(float) * rows);
+            spectrogram -> columns++;
+        }
+    }
+    spectrogram -> next += count * hop;
+    spectrum_plan_release(plan);
+    if (spectrogram -> image != NULL) {
+        traceGLImageColumns(spectrogram -> image, columns, count);
+    }
+}
+
+void renderSpectrogramData() {
+    int windowIndex = ilog2(WINDOW_SPECTROGRAM);
+    int sideAxisWidth = 10;
+    int bottomAxisHeight = 10;
+    spectrogram_t *spectrogram = &self.spectrogram;
+    if (self.windows[windowIndex].minimize) {
+        spectrogram -> channel = NULL; // nothing is transformed while the window is closed, the STFT restarts when it opens
+    }
+    if (self.windows[windowIndex].minimize == 0) {
+        spectrogramUpdate();
+        /* render window background */
+        turtleRectangle(self.windows[windowIndex].windowCoords[0], self.windows[windowIndex].windowCoords[1], self.windows[windowIndex].windowCoords[2], self.windows[windowIndex].windowCoords[3], self.themeColors[self.theme + 12], self.themeColors[self.theme + 13], self.themeColors[self.theme + 14], 0);
+        double left = self.windows[windowIndex].windowCoords[0] + sideAxisWidth;
+        double bottom = self.windows[windowIndex].windowCoords[1] + bottomAxisHeight;
+        double right = self.windows[windowIndex].windowCoords[2] - self.windows[windowIndex].windowSide;
+        double top = self.windows[windowIndex].windowCoords[3] - self.windows[windowIndex].windowTop;
+        int rows = spectrogram -> size / 2 + 1;
+        float *history = spectrogram -> history.data;
+        if (spectrogram -> image != NULL) {
+            /* render image, newest column at the right edge */
+            traceGLImageDraw(spectrogram -> image, left, bottom, right, top, spectrogram -> top - spectrogram -> range, spectrogram -> top);
+        } else {
+            /* no GPU image, render a coarse grid of cells from the history with the turtle */
+            unsigned char rgb[256 * 3];
+            spectrogramColors(spectrogram -> colormap, rgb);
+            int cellsX = 64;
+            int cellsY = 48;
+            for (int x = 0; x < cellsX; x++) {
+                int64_t column = spectrogram -> columns - SPECTROGRAM_HISTORY + (int64_t) (x + 0.5) * SPECTROGRAM_HISTORY / cellsX;
+                if (column < 0) {
+                    continue;
+                }
+                for (int y = 0; y < cellsY; y++) {
+                    int row = (y + 0.5) * rows / cellsY;
+                    double level = (history[(column % SPECTROGRAM_HISTORY) * rows + row] - spectrogram -> top + spectrogram -> range) / spectrogram -> range;
+                    int color = fmin(fmax(level, 0), 1) * 255;
+                    turtleRectangle(left + (right - left) * x / cellsX, bottom + (top - bottom) * y / cellsY, left + (right - left) * (x + 1) / cellsX, bottom + (top - bottom) * (y + 1) / cellsY, rgb[color * 3], rgb[color * 3 + 1], rgb[color * 3 + 2], 0);
+                }
+            }
+        }
+        /* render mouse */
+        if (self.mx > left && self.mx < right && self.my > bottom && self.my < top) {
+            int64_t columnsBack = (right - self.mx) / (right - left) * SPECTROGRAM_HISTORY;
+            int row = round((self.my - bottom) / (top - bottom) * rows - 0.5);
+            if (columnsBack < spectrogram -> columns && row >= 0 && row < rows) {
+                int64_t column = spectrogram -> columns - 1 - columnsBack;
+                double value = history[(column % SPECTROGRAM_HISTORY) * rows + row];
+                turtleRectangle(self.mx - 1, top, self.mx + 1, bottom, self.themeColors[self.theme + 21], self.themeColors[self.theme + 22], self.themeColors[self.theme + 23], 100);
+                turtleRectangle(left, self.my - 1, right, self.my + 1, self.themeColors[self.theme + 21], self.themeColors[self.theme + 22], self.themeColors[self.theme + 23], 100);
+                char sampleValue[64];
+                sprintf(sampleValue, "%.1lfHz %.1lfdB %.2lfs ago", row * spectrogram -> samplesPerSecond / spectrogram -> size, value, (double) columnsBack * spectrogram -> hop / spectrogram -> samplesPerSecond);
+                double boxLength = textGLGetStringLength(sampleValue, 8);
+                double boxX = self.mx - boxLength / 2;
+                if (boxX - 5 < left) {
+                    boxX = left + 5;
+                }
+                if (boxX + boxLength + 5 > right) {
+                    boxX = right - boxLength - 5;
+                }
+                turtleRectangle(boxX - 2, top - 15, boxX + boxLength + 2, top - 5, 215, 215, 215, 0);
+                turtlePenColor(0, 0, 0);
+                textGLWriteString(sampleValue, boxX, top - 10, 8, 0);
+            }
+        }
+        /* render side and bottom axis */
+        turtleRectangle(self.windows[windowIndex].windowCoords[0], self.windows[windowIndex].windowCoords[1], left, self.windows[windowIndex].windowCoords[3], self.themeColors[self.theme + 21], self.themeColors[self.theme + 22], self.themeColors[self.theme + 23], 100);
+        turtleRectangle(left, self.windows[windowIndex].windowCoords[1], right, bottom, self.themeColors[self.theme + 21], self.themeColors[self.theme + 22], self.themeColors[self.theme + 23], 100);
+    }
+}
+
+/* fundamental phase (radians, unwrapped) at sample index of a tracked channel
+a fixed fundamental counts cycles from index 0, a speed reference (Hz) is integrated sample by sample and an angle reference (radians) is unwrapped */
+double harmonicPhase(harmonic_channel_t *tracked, int64_t index, int64_t offset, double samplesPerSecond) {
+    harmonic_view_t *view = &self.harmonic;
+    if (view -> reference == HARMONIC_FIXED) {
+        return 2 * M_PI * view -> fundamental * index / samplesPerSecond;
+    }
+    channel_t *reference = self.data -> data[view -> referenceIndex].p;
+    if (reference -> length == 0) {
+        return 0;
+    }
+    int64_t referenceIndex = index + offset;
+    if (referenceIndex < channel_start(reference)) {
+        referenceIndex = channel_start(reference);
+    }
+    if (referenceIndex >= reference -> length) {
+        referenceIndex = reference -> length - 1;
+    }
+    if (view -> reference == HARMONIC_SPEED) {
+        double referencePerSecond = ((logVariable_t *) self.logVariables -> data[view -> referenceIndex].p) -> samplesPerSecond;
+        if (tracked -> referenceIndex < 0) {
+            tracked -> referenceIndex = referenceIndex;
+        }
+        while (tracked -> referenceIndex < referenceIndex) {
+            tracked -> referenceIndex++;
+            tracked -> phase += 2 * M_PI * channel_get(reference, tracked -> referenceIndex) / referencePerSecond;
+        }
+        return tracked -> phase;
+    }
+    double angle = channel_get(reference, referenceIndex);
+    if (tracked -> referenceIndex < 0) {
+        tracked -> phase = angle;
+    } else {
+        double step = fmod(angle - tracked -> angle, 2 * M_PI);
+        if (step > M_PI) {
+            step -= 2 * M_PI;
+        } else if (step < -M_PI) {
+            step += 2 * M_PI;
+        }
+        tracked -> phase += step;
+    }
+    tracked -> angle = angle;
+    tracked -> referenceIndex = referenceIndex;
+    return tracked -> phase;
+}
+
+/* fundamental the harmonic view is tracking (Hz) - the fixed setting, or measured over the trend channel's window once it has samples */
+double harmonicFundamental() {
+    harmonic_view_t *view = &self.harmonic;
+    harmonic_channel_t *tracked = &view -> channel[view -> trendChannel];
+    if (view -> reference != HARMONIC_FIXED && tracked -> channel != NULL && tracked -> tracker.count >= 2) {
+        double samplesPerSecond = ((logVariable_t *) self.logVariables -> data[self.osc[view -> oscIndex].dataIndex[view -> trendChannel]].p) -> samplesPerSecond;
+        return fabs(harmonic_frequency(&tracked -> tracker, samplesPerSecond));
+    }
+    return view -> fundamental;
+}
+
+/* called once per frame on the render thread after the new samples are in the channels - pushes every new sample of the oscilloscope's channels through their trackers
+a tracker restarts (refilling its window from the channel) when its source or settings change, or when the fundamental drifts enough to change its window by a tenth
+the work per sample is a sincos and a few multiplies per harmonic, far less than transforming the channel every frame */
+void harmonicIngest() {
+    harmonic_view_t *view = &self.harmonic;
+    if (self.windows[ilog2(WINDOW_HARMONIC)].minimize) {
+        return; // nothing is tracked while the window is closed, the trackers refill their windows when it opens
+    }
+    if (view -> oscIndex >= self.newOsc) {
+        view -> oscIndex = 0;
+    }
+    if (view -> referenceIndex >= self.data -> length) {
+        view -> referenceIndex = 0;
+    }
+    int harmonics = round(view -> harmonicsDial);
+    int restart = harmonics != view -> harmonics || view -> reference != view -> appliedReference || view -> referenceIndex != view -> appliedReferenceIndex || view -> oscIndex != view -> appliedOsc;
+    view -> harmonics = harmonics;
+    view -> appliedReference = view -> reference;
+    view -> appliedReferenceIndex = view -> referenceIndex;
+    view -> appliedOsc = view -> oscIndex;
+    if (restart) {
+        view -> trendHead = 0;
+        view -> trendLength = 0;
+    }
+    double fundamental = harmonicFundamental();
+    if (fundamental <= 0) {
+        fundamental = view -> fundamental;
+    }
+    int pushed = 0;
+    for (int i = 0; i < 4; i++) {
+        harmonic_channel_t *tracked = &view -> channel[i];
+        int dataIndex = self.osc[view -> oscIndex].dataIndex[i];
+        if (dataIndex == 0) {
+            if (tracked -> channel != NULL) {
+                harmonic_free(&tracked -> tracker);
+                tracked -> channel = NULL;
+            }
+            continue;
+        }
+        channel_t *channel = self.data -> data[dataIndex].p;
+        double samplesPerSecond = ((logVariable_t *) self.logVariables -> data[dataIndex].p) -> samplesPerSecond;
+        int window = round(view -> cycles * samplesPerSecond / fundamental);
+        if (window > HARMONIC_MAX_WINDOW) {
+            window = HARMONIC_MAX_WINDOW;
+        }
+        if (tracked -> channel != NULL && (channel != tracked -> channel || restart || abs(window - tracked -> tracker.window) * 10 > tracked -> tracker.window)) {
+            harmonic_free(&tracked -> tracker);
+            tracked -> channel = NULL;
+        }
+        if (tracked -> channel == NULL) {
+            harmonic_init(&tracked -> tracker, harmonics, window);
+            tracked -> channel = channel;
+            tracked -> next = channel -> length - tracked -> tracker.window;
+            tracked -> referenceIndex = -1;
+            tracked -> phase = 0;
+        }
+        if (tracked -> next < channel_start(channel)) {
+            tracked -> next = channel_start(channel);
+        }
+        if (channel -> length - tracked -> next > tracked -> tracker.window) {
+            /* more than a window behind, older samples would only be pushed out again */
+            harmonic_clear(&tracked -> tracker);
+            tracked -> next = channel -> length - tracked -> tracker.window;
+            tracked -> referenceIndex = -1;
+            tracked -> phase = 0;
+        }
+        if (tracked -> next >= channel -> length) {
+            continue;
+        }
+        /* line the reference up with this channel by timestamp, or by their newest samples if either has none */
+        int64_t offset = 0;
+        if (view -> reference != HARMONIC_FIXED) {
+            channel_t *reference = self.data -> data[view -> referenceIndex].p;
+            if (channel -> anchorLength > 0 && reference -> anchorLength > 0) {
+                offset = llround(channel_index_at(reference, channel_time(channel, tracked -> next))) - tracked -> next;
+            } else {
+                offset = reference -> length - channel -> length;
+            }
+        }
+        for (int64_t j = tracked -> next; j < channel -> length; j++) {
+            harmonic_push(&tracked -> tracker, channel_get(channel, j), harmonicPhase(tracked, j, offset, samplesPerSecond));
+        }
+        tracked -> next = channel -> length;
+        if (i == view -> trendChannel) {
+            pushed = 1;
+        }
+    }
+    /* one row of trend lines per frame that brought new samples */
+    harmonic_channel_t *tracked = &view -> channel[view -> trendChannel];
+    if (pushed && tracked -> channel != NULL) {
+        for (int h = 0; h < HARMONIC_MAX; h++) {
+            view -> trend[view -> trendHead][h] = harmonic_amplitude(&tracked -> tracker, h + 1);
+        }
+        view -> trendHead = (view -> trendHead + 1) % HARMONIC_TREND;
+        if (view -> trendLength < HARMONIC_TREND) {
+            view -> trendLength++;
+        }
+    }
+}
+
+void renderHarmonicData() {
+    int windowIndex = ilog2(WINDOW_HARMONIC);
+    harmonic_view_t *view = &self.harmonic;
+    if (self.windows[windowIndex].minimize) {
+        return;
+    }
+    /* render window background */
+    turtleRectangle(self.windows[windowIndex].windowCoords[0], self.windows[windowIndex].windowCoords[1], self.windows[windowIndex].windowCoords[2], self.windows[windowIndex].windowCoords[3], self.themeColors[self.theme + 12], self.themeColors[self.theme + 13], self.themeColors[self.theme + 14], 0);
+    double left = self.windows[windowIndex].windowCoords[0] + 5;
+    double right = self.windows[windowIndex].windowCoords[2] - self.windows[windowIndex].windowSide - 5;
+    double top = self.windows[windowIndex].windowCoords[3] - self.windows[windowIndex].windowTop - 5;
+    double rowHeight = 9;
+    double tableTop = self.windows[windowIndex].windowCoords[1] + 5 + (view -> harmonics + 1) * rowHeight;
+    double fundamental = harmonicFundamental();
+    /* render trend lines, newest at the right edge, scaled to the largest amplitude shown */
+    double largest = 0;
+    for (int i = 0; i < view -> trendLength; i++) {
+        int row = (view -> trendHead - view -> trendLength + i + HARMONIC_TREND) % HARMONIC_TREND;
+        for (int h = 0; h < view -> harmonics; h++) {
+            if (view -> trend[row][h] > largest) {
+                largest = view -> trend[row][h];
+            }
+        }
+    }
+    if (largest > 0 && view -> trendLength > 1) {
+        double bottom = tableTop + 5;
+        double scale = (top - 10 - bottom) / largest;
+        turtlePenSize(1);
+        for (int h = 0; h < view -> harmonics; h++) {
+            turtlePenColor(harmonicColors[(h % 8) * 3], harmonicColors[(h % 8) * 3 + 1], harmonicColors[(h % 8) * 3 + 2]);
+            for (int i = 0; i < view -> trendLength; i++) {
+                int row = (view -> trendHead - view -> trendLength + i + HARMONIC_TREND) % HARMONIC_TREND;
+                turtleGoto(right - (right - left) * (view -> trendLength - 1 - i) / (HARMONIC_TREND - 1), bottom + view -> trend[row][h] * scale);
+                turtlePenDown();
+            }
+            turtlePenUp();
+        }
+        char scaleValue[24];
+        sprintf(scaleValue, "%.3g", largest);
+        turtlePenColor(self.themeColors[self.theme + 9], self.themeColors[self.theme + 10], self.themeColors[self.theme + 11]);
+        textGLWriteString(scaleValue, left, top - 4, 6, 0);
+    }
+    /* render table - one row per harmonic, amplitude and phase (degrees from the fundamental) of every tracked channel */
+    int columns = 0;
+    for (int i = 0; i < 4; i++) {
+        columns += view -> channel[i].channel != NULL;
+    }
+    double firstColumn = 55;
+    double columnWidth = columns > 0 ? (right - left - firstColumn) / columns : 0;
+    char cell[48];
+    turtlePenColor(self.themeColors[self.theme + 9], self.themeColors[self.theme + 10], self.themeColors[self.theme + 11]);
+    textGLWriteString("Hz", left, tableTop - rowHeight / 2, 6, 0);
+    for (int h = 1; h <= view -> harmonics; h++) {
+        double y = tableTop - (h + 0.5) * rowHeight;
+        turtlePenColor(harmonicColors[((h - 1) % 8) * 3], harmonicColors[((h - 1) % 8) * 3 + 1], harmonicColors[((h - 1) % 8) * 3 + 2]);
+        sprintf(cell, "%d: %.1lf", h, h * fundamental);
+        textGLWriteString(cell, left, y, 6, 0);
+    }
+    int column = 0;
+    for (int i = 0; i < 4; i++) {
+        harmonic_channel_t *tracked = &view -> channel[i];
+        if (tracked -> channel == NULL) {
+            continue;
+        }
+        double x = left + firstColumn + column * columnWidth;
+        turtlePenColor(self.themeColors[self.theme + 24 + i * 3], self.themeColors[self.theme + 25 + i * 3], self.themeColors[self.theme + 26 + i * 3]);
+        textGLWriteString(((logVariable_t *) self.logVariables -> data[self.osc[view -> oscIndex].dataIndex[i]].p) -> name, x, tableTop - rowHeight / 2, 6, 0);
+        turtlePenColor(self.themeColors[self.theme + 9], self.themeColors[self.theme + 10], self.themeColors[self.theme + 11]);
+        for (int h = 1; h <= view -> harmonics; h++) {
+            sprintf(cell, "%.3g  %.0lf", harmonic_amplitude(&tracked -> tracker, h), harmonic_phase(&tracked -> tracker, h) * 180 / M_PI);
+            textGLWriteString(cell, x, tableTop - (h + 0.5) * rowHeight, 6, 0);
+        }
+        column++;
+    }
+}
+
 void renderEditorData() {
     int windowIndex = ilog2(WINDOW_EDITOR);
     if (self.windows[windowIndex].minimize == 0) {
@@ -2002,11 +4012,105 @@ void renderEditorData() {
     }
 }
 
+/* value of a channel at a time in seconds, linearly interpolated between the samples either side */
+double orbitInterpolate(int dataIndex, double time) {
+    double preciseIndex = sampleIndexAtTime(dataIndex, time);
+    int64_t lower = floor(preciseIndex);
+    double valueLower = channel_get(self.data -> data[dataIndex].p, lower);
+    double valueUpper = channel_get(self.data -> data[dataIndex].p, lower + 1);
+    return valueLower + (valueUpper - valueLower) * (preciseIndex - lower);
+}
+
+/*
+merge whatever arrived on the X and Y sources since the last frame into orbit points
+the two sources are walked in time order, every sample of either one becomes a point and the other axis is interpolated at that sample's time
+a point is only made once the other source has a sample at or after it, so nothing is extrapolated
+an unused source (dataIndex 0) reads as 0 and the merge follows the other source alone
+*/
+void orbitMerge(int orbitIndex) {
+    orbit_t *orbit = &self.orbit[orbitIndex];
+    channel_t *source[2];
+    for (int i = 0; i < 2; i++) {
+        source[i] = self.data -> data[orbit -> dataIndex[i]].p;
+    }
+    char rebuild = 0;
+    for (int i = 0; i < 2; i++) {
+        if (source[i] != orbit -> mergedSource[i] || orbit -> mergeCursor[i] > source[i] -> length || orbit -> mergeCursor[i] < channel_start(source[i])) {
+            rebuild = 1;
+        }
+    }
+    if (rebuild) {
+        /* start from the most recent stretch of both sources */
+        for (int i = 0; i < 2; i++) {
+            orbit -> merged[i] -> length = 0;
+            orbit -> mergedSource[i] = source[i];
+            orbit -> mergeCursor[i] = source[i] -> length - ORBIT_MERGE_LENGTH;
+            if (orbit -> mergeCursor[i] < channel_start(source[i])) {
+                orbit -> mergeCursor[i] = channel_start(source[i]);
+            }
+        }
+        orbit -> stopIndex = 0;
+        pointgrid_reset(&orbit -> grid, 0, orbit -> grid.cellX, orbit -> grid.cellY);
+        if (orbit -> mirror != NULL) {
+            /* contents changed under the same pointers, upload them again */
+            orbit -> mirror -> x -> channel = NULL;
+            orbit -> mirror -> y -> channel = NULL;
+        }
+    }
+    char used[2] = {orbit -> dataIndex[0] > 0 && source[0] -> length > 0, orbit -> dataIndex[1] > 0 && source[1] -> length > 0};
+    if (!used[0] && !used[1]) {
+        return;
+    }
+    double newest[2];
+    for (int i = 0; i < 2; i++) {
+        if (used[i]) {
+            newest[i] = sampleTime(orbit -> dataIndex[i], source[i] -> length - 1);
+        }
+    }
+    while (1) {
+        /* pick the earlier of the next sample on each source */
+        double time[2];
+        char ready[2];
+        for (int i = 0; i < 2; i++) {
+            ready[i] = used[i] && orbit -> mergeCursor[i] < source[i] -> length;
+            if (ready[i]) {
+                time[i] = sampleTime(orbit -> dataIndex[i], orbit -> mergeCursor[i]);
+            }
+        }
+        int next;
+        if (ready[0] && ready[1]) {
+            next = time[0] <= time[1] ? 0 : 1;
+        } else if (ready[0] && !used[1]) {
+            next = 0;
+        } else if (ready[1] && !used[0]) {
+            next = 1;
+        } else {
+            break; // waiting on the other source
+        }
+        int other = 1 - next;
+        double point[2];
+        point[next] = channel_get(source[next], orbit -> mergeCursor[next]);
+        if (used[other]) {
+            if (newest[other] < time[next]) {
+                break;
+            }
+            if (ready[other] && time[other] == time[next]) {
+                /* both sources have a sample at this time, use it as is */
+                point[other] = channel_get(source[other], orbit -> mergeCursor[other]);
+                orbit -> mergeCursor[other]++;
+            } else {
+                point[other] = orbitInterpolate(orbit -> dataIndex[other], time[next]);
+            }
+        } else {
+            point[other] = 0;
+        }
+        orbit -> mergeCursor[next]++;
+        channel_append(orbit -> merged[0], point[0]);
+        channel_append(orbit -> merged[1], point[1]);
+    }
+}
+
 void renderOrbitData(int orbitIndex) {
-    /*
-    TODO
-    time sync
-    */
     int windowIndex = ilog2(WINDOW_ORBIT) + orbitIndex;
     if (self.windows[windowIndex].minimize == 0) {
         /* render window background */
@@ -2014,19 +4118,48 @@ void renderOrbitData(int orbitIndex) {
         /* render data */
         turtlePenSize(1);
         turtlePenColor(self.themeColors[self.theme + 6], self.themeColors[self.theme + 7], self.themeColors[self.theme + 8]);
+        channel_t *mergedX = self.orbit[orbitIndex].merged[0];
+        channel_t *mergedY = self.orbit[orbitIndex].merged[1];
         if (!self.orbit[orbitIndex].stop) {
-            self.orbit[orbitIndex].stopIndex[0] = self.data -> data[self.orbit[orbitIndex].dataIndex[0]].r -> length;
-            self.orbit[orbitIndex].stopIndex[1] = self.data -> data[self.orbit[orbitIndex].dataIndex[1]].r -> length;
+            orbitMerge(orbitIndex);
+            self.orbit[orbitIndex].stopIndex = mergedX -> length;
         }
-        double orbitX = (self.windows[windowIndex].windowCoords[0] + self.windows[windowIndex].windowCoords[2] - self.windows[windowIndex].windowSide) / 2 + self.orbit[orbitIndex].offset[0] / self.orbit[orbitIndex].scale[0] * (self.windows[windowIndex].windowCoords[2] - self.windows[windowIndex].windowSide - self.windows[windowIndex].windowCoords[0]);
-        double orbitY = (self.windows[windowIndex].windowCoords[1] + self.windows[windowIndex].windowCoords[3] - self.windows[windowIndex].windowTop) / 2 + self.orbit[orbitIndex].offset[1] / self.orbit[orbitIndex].scale[1] * (self.windows[windowIndex].windowCoords[3] - self.windows[windowIndex].windowTop - self.windows[windowIndex].windowCoords[1]);
-        for (int i = 1; i < self.orbit[orbitIndex].samples; i++) {
-            if (self.orbit[orbitIndex].stopIndex[0] > i) {
-                orbitX = (self.windows[windowIndex].windowCoords[0] + self.windows[windowIndex].windowCoords[2] - self.windows[windowIndex].windowSide) / 2 + ((self.data -> data[self.orbit[orbitIndex].dataIndex[0]].r -> data[self.orbit[orbitIndex].stopIndex[0] - i - 1].d + self.orbit[orbitIndex].offset[0]) / self.orbit[orbitIndex].scale[0]) * (self.windows[windowIndex].windowCoords[2] - self.windows[windowIndex].windowSide - self.windows[windowIndex].windowCoords[0]);
-            }
-            if (self.orbit[orbitIndex].stopIndex[1] > i) {
-                orbitY = (self.windows[windowIndex].windowCoords[1] + self.windows[windowIndex].windowCoords[3] - self.windows[windowIndex].windowTop) / 2 + ((self.data -> data[self.orbit[orbitIndex].dataIndex[1]].r -> data[self.orbit[orbitIndex].stopIndex[1] - i - 1].d + self.orbit[orbitIndex].offset[1]) / self.orbit[orbitIndex].scale[1]) * (self.windows[windowIndex].windowCoords[3] - self.windows[windowIndex].windowTop - self.windows[windowIndex].windowCoords[1]);
+        /* number of points behind stopIndex that have not been overwritten yet */
+        int64_t available = self.orbit[orbitIndex].stopIndex - channel_start(mergedX);
+        double centerX = (self.windows[windowIndex].windowCoords[0] + self.windows[windowIndex].windowCoords[2] - self.windows[windowIndex].windowSide) / 2;
+        double centerY = (self.windows[windowIndex].windowCoords[1] + self.windows[windowIndex].windowCoords[3] - self.windows[windowIndex].windowTop) / 2;
+        double spanX = self.windows[windowIndex].windowCoords[2] - self.windows[windowIndex].windowSide - self.windows[windowIndex].windowCoords[0];
+        double spanY = self.windows[windowIndex].windowCoords[3] - self.windows[windowIndex].windowTop - self.windows[windowIndex].windowCoords[1];
+        /* keep the hover grid on the points the trail shows, adding the new ones and dropping the ones that left */
+        pointgrid_t *grid = &self.orbit[orbitIndex].grid;
+        int64_t shown = ceil(self.orbit[orbitIndex].samples);
+        if (shown > available) {
+            shown = available;
+        }
+        int64_t first = self.orbit[orbitIndex].stopIndex - shown;
+        double cellX = self.orbit[orbitIndex].scale[0] / ORBIT_GRID_CELLS;
+        double cellY = self.orbit[orbitIndex].scale[1] / ORBIT_GRID_CELLS;
+        if (cellX != grid -> cellX || cellY != grid -> cellY || first < grid -> first || first > grid -> last || self.orbit[orbitIndex].stopIndex < grid -> last) {
+            pointgrid_reset(grid, first, cellX, cellY);
+        }
+        while (grid -> first < first) {
+            pointgrid_pop(grid);
+        }
+        while (grid -> last < self.orbit[orbitIndex].stopIndex) {
+            pointgrid_push(grid, channel_get(mergedX, grid -> last), channel_get(mergedY, grid -> last));
+        }
+        /* the trail is drawn from a GPU copy of the merged points, only the points merged since last frame are uploaded */
+        char drawn = 0;
+        if (traceGLRender.enabled) {
+            if (self.orbit[orbitIndex].mirror == NULL) {
+                self.orbit[orbitIndex].mirror = traceGLPairInit();
             }
+            drawn = traceGLPairDraw(self.orbit[orbitIndex].mirror, mergedX, mergedY, first, self.orbit[orbitIndex].stopIndex, centerX + self.orbit[orbitIndex].offset[0] / self.orbit[orbitIndex].scale[0] * spanX, spanX / self.orbit[orbitIndex].scale[0], centerY + self.orbit[orbitIndex].offset[1] / self.orbit[orbitIndex].scale[1] * spanY, spanY / self.orbit[orbitIndex].scale[1], self.themeColors[self.theme + 6], self.themeColors[self.theme + 7], self.themeColors[self.theme + 8], 1);
+        }
+        /* the turtle redraws every point every frame, so without traceGL only the newest ORBIT_TURTLE_LENGTH are drawn */
+        for (int i = 0; i < shown && i < ORBIT_TURTLE_LENGTH && !drawn; i++) {
+            double orbitX = centerX + (channel_get(mergedX, self.orbit[orbitIndex].stopIndex - i - 1) + self.orbit[orbitIndex].offset[0]) / self.orbit[orbitIndex].scale[0] * spanX;
+            double orbitY = centerY + (channel_get(mergedY, self.orbit[orbitIndex].stopIndex - i - 1) + self.orbit[orbitIndex].offset[1]) / self.orbit[orbitIndex].scale[1] * spanY;
             turtleGoto(orbitX, orbitY);
             turtlePenDown();
         }
@@ -2034,30 +4167,19 @@ void renderOrbitData(int orbitIndex) {
         /* render mouse */
         if (self.mx > self.windows[windowIndex].windowCoords[0] + 15 && self.my > self.windows[windowIndex].windowCoords[1] + 15 && self.mx < self.windows[windowIndex].windowCoords[2] && self.my < self.windows[windowIndex].windowCoords[3] - self.windows[windowIndex].windowTop) {
             /* find closest point on orbit plot */
-            int closestIndex = -1;
-            double distClosest = 10000.0;
-            for (int i = 0; i < self.orbit[orbitIndex].samples; i++) {
-                if (self.orbit[orbitIndex].stopIndex[0] >= i && self.orbit[orbitIndex].stopIndex[1] >= i) {
-                    double xDist = (self.windows[windowIndex].windowCoords[0] + self.windows[windowIndex].windowCoords[2] - self.windows[windowIndex].windowSide) / 2 + (self.data -> data[self.orbit[orbitIndex].dataIndex[0]].r -> data[self.orbit[orbitIndex].stopIndex[0] - i - 1].d + self.orbit[orbitIndex].offset[0]) / self.orbit[orbitIndex].scale[0] * (self.windows[windowIndex].windowCoords[2] - self.windows[windowIndex].windowSide - self.windows[windowIndex].windowCoords[0]) - self.mx;
-                    double yDist = (self.windows[windowIndex].windowCoords[1] + self.windows[windowIndex].windowCoords[3] - self.windows[windowIndex].windowTop) / 2 + (self.data -> data[self.orbit[orbitIndex].dataIndex[1]].r -> data[self.orbit[orbitIndex].stopIndex[1] - i - 1].d + self.orbit[orbitIndex].offset[1]) / self.orbit[orbitIndex].scale[1] * (self.windows[windowIndex].windowCoords[3] - self.windows[windowIndex].windowTop - self.windows[windowIndex].windowCoords[1]) - self.my;
-                    double distSquared = xDist * xDist + yDist * yDist;
-                    if (distSquared < distClosest) {
-                        distClosest = distSquared;
-                        closestIndex = i;
-                    }
-                } else {
-                    break;
-                }
+            int64_t closestIndex = -1;
+            double distClosest = ORBIT_DIST_THRESH;
+            double mouseX = (self.mx - centerX) / spanX * self.orbit[orbitIndex].scale[0] - self.orbit[orbitIndex].offset[0];
+            double mouseY = (self.my - centerY) / spanY * self.orbit[orbitIndex].scale[1] - self.orbit[orbitIndex].offset[1];
+            int64_t closestPoint = pointgrid_nearest(grid, mouseX, mouseY, spanX / self.orbit[orbitIndex].scale[0], spanY / self.orbit[orbitIndex].scale[1], ORBIT_DIST_THRESH, &distClosest);
+            if (closestPoint != -1) {
+                closestIndex = self.orbit[orbitIndex].stopIndex - closestPoint - 1;
             }
             if (closestIndex != -1 && distClosest < ORBIT_DIST_THRESH) {
-                double orbitX = (self.windows[windowIndex].windowCoords[0] + self.windows[windowIndex].windowCoords[2] - self.windows[windowIndex].windowSide) / 2;
-                double orbitY = (self.windows[windowIndex].windowCoords[1] + self.windows[windowIndex].windowCoords[3] - self.windows[windowIndex].windowTop) / 2;
-                if (self.orbit[orbitIndex].stopIndex[0] >= closestIndex) {
-                    orbitX = (self.windows[windowIndex].windowCoords[0] + self.windows[windowIndex].windowCoords[2] - self.windows[windowIndex].windowSide) / 2 + (self.data -> data[self.orbit[orbitIndex].dataIndex[0]].r -> data[self.orbit[orbitIndex].stopIndex[0] - closestIndex - 1].d + self.orbit[orbitIndex].offset[0]) / self.orbit[orbitIndex].scale[0] * (self.windows[windowIndex].windowCoords[2] - self.windows[windowIndex].windowSide - self.windows[windowIndex].windowCoords[0]);
-                }
-                if (self.orbit[orbitIndex].stopIndex[1] >= closestIndex) {
-                    orbitY = (self.windows[windowIndex].windowCoords[1] + self.windows[windowIndex].windowCoords[3] - self.windows[windowIndex].windowTop) / 2 + (self.data -> data[self.orbit[orbitIndex].dataIndex[1]].r -> data[self.orbit[orbitIndex].stopIndex[1] - closestIndex - 1].d + self.orbit[orbitIndex].offset[1]) / self.orbit[orbitIndex].scale[1] * (self.windows[windowIndex].windowCoords[3] - self.windows[windowIndex].windowTop - self.windows[windowIndex].windowCoords[1]);
-                }
+                double valueX = channel_get(mergedX, self.orbit[orbitIndex].stopIndex - closestIndex - 1);
+                double valueY = channel_get(mergedY, self.orbit[orbitIndex].stopIndex - closestIndex - 1);
+                double orbitX = centerX + (valueX + self.orbit[orbitIndex].offset[0]) / self.orbit[orbitIndex].scale[0] * spanX;
+                double orbitY = centerY + (valueY + self.orbit[orbitIndex].offset[1]) / self.orbit[orbitIndex].scale[1] * spanY;
                 turtleRectangle(orbitX - 1, self.windows[windowIndex].windowCoords[3] - self.windows[windowIndex].windowTop, orbitX + 1, self.windows[windowIndex].windowCoords[1], self.themeColors[self.theme + 21], self.themeColors[self.theme + 22], self.themeColors[self.theme + 23], 100);
                 turtleRectangle(self.windows[windowIndex].windowCoords[0], orbitY - 1, self.windows[windowIndex].windowCoords[2], orbitY + 1, self.themeColors[self.theme + 21], self.themeColors[self.theme + 22], self.themeColors[self.theme + 23], 100);
                 turtleGoto(orbitX, orbitY);
@@ -2067,7 +4189,7 @@ void renderOrbitData(int orbitIndex) {
                 turtlePenUp();
                 char sampleValue[24];
                 /* render side box */
-                sprintf(sampleValue, "%.02lf", self.data -> data[self.orbit[orbitIndex].dataIndex[1]].r -> data[self.orbit[orbitIndex].stopIndex[1] - closestIndex - 1].d);
+                sprintf(sampleValue, "%.02lf", valueY);
                 double boxLength = textGLGetStringLength(sampleValue, 8);
                 double boxX = self.windows[windowIndex].windowCoords[0] + 12;
                 if (orbitX - boxX < 40) {
@@ -2078,7 +4200,7 @@ void renderOrbitData(int orbitIndex) {
                 turtlePenColor(0, 0, 0);
                 textGLWriteString(sampleValue, boxX + 2, boxY - 1, 8, 0);
                 /* render top box */
-                sprintf(sampleValue, "%.02lf", self.data -> data[self.orbit[orbitIndex].dataIndex[0]].r -> data[self.orbit[orbitIndex].stopIndex[0] - closestIndex - 1].d);
+                sprintf(sampleValue, "%.02lf", valueX);
                 double boxLength2 = textGLGetStringLength(sampleValue, 8);
                 double boxY2 = orbitY + 10;
                 double boxX2 = orbitX - boxLength2 / 2;
@@ -2194,6 +4316,7 @@ void renderInfoData() {
                 for (int i = 1; i < self.logVariables -> length; i++) {
                     logVariable_t *variable = self.logVariables -> data[i].p;
                     if (variable -> socketPtr != NULL) {
+                        win32tcpUnwatchSocket(variable -> socketPtr);
                         closesocket(*(variable -> socketPtr));
                     }
                 }
@@ -2225,6 +4348,11 @@ void renderInfoData() {
                 }
             }
         }
+        /* retention dial - only resize once the dial is let go */
+        if (self.retentionSeconds != self.appliedRetentionSeconds && self.mouseDown == 0) {
+            self.retentionSamples = 0; // turning the dial overrides retention_samples from the config
+            applyRetention();
+        }
         /* render data */
         double nameColumnWidth = textGLGetStringLength("Name", 8);
         turtlePenColor(self.themeColors[self.theme + 9], self.themeColors[self.theme + 10], self.themeColors[self.theme + 11]);
@@ -2242,7 +4370,7 @@ void renderInfoData() {
         turtleRectangle(self.windows[windowIndex].windowCoords[0] + nameColumnWidth + 20, self.windows[windowIndex].windowCoords[1], self.windows[windowIndex].windowCoords[0] + nameColumnWidth + 35 + samplesColumnWidth + 5, self.windows[windowIndex].windowCoords[3], self.themeColors[self.theme + 0] - 8, self.themeColors[self.theme + 1] - 8, self.themeColors[self.theme + 2] - 8, 0);
         textGLWriteString("Samples/s", self.windows[windowIndex].windowCoords[0] + nameColumnWidth + 30 + samplesColumnWidth / 2, self.windows[windowIndex].windowCoords[3] - self.windows[windowIndex].windowTop - 10, 8, 50);
         for (int i = 1; i < self.logVariables -> length; i++) {
-            int samplesPerSecond = self.data -> data[i].r -> data[0].d;
+            int samplesPerSecond = ((logVariable_t *) self.logVariables -> data[i].p) -> samplesPerSecond;
             char sampleString[24];
             sprintf(sampleString, "%d", samplesPerSecond);
             textGLWriteString(sampleString, self.windows[windowIndex].windowCoords[0] + nameColumnWidth + 30 + samplesColumnWidth / 2, self.windows[windowIndex].windowCoords[3] - self.windows[windowIndex].windowTop - 25 - (i - 1) * 10, 6, 50);
@@ -2251,16 +4379,16 @@ void renderInfoData() {
         turtleRectangle(self.windows[windowIndex].windowCoords[0] + nameColumnWidth + 40 + samplesColumnWidth, self.windows[windowIndex].windowCoords[1], self.windows[windowIndex].windowCoords[0] + nameColumnWidth + 60 + samplesColumnWidth + totalColumnWidth, self.windows[windowIndex].windowCoords[3], self.themeColors[self.theme + 0] - 16, self.themeColors[self.theme + 1] - 16, self.themeColors[self.theme + 2] - 16, 0);
         textGLWriteString("Total Samples", self.windows[windowIndex].windowCoords[0] + nameColumnWidth + 50 + samplesColumnWidth + totalColumnWidth / 2, self.windows[windowIndex].windowCoords[3] - self.windows[windowIndex].windowTop - 10, 8, 50);
         for (int i = 1; i < self.logVariables -> length; i++) {
-            int totalSamples = self.data -> data[i].r -> length - 1;
+            int64_t totalSamples = ((channel_t *) self.data -> data[i].p) -> length;
             char sampleString[24];
-            sprintf(sampleString, "%d", totalSamples);
+            sprintf(sampleString, "%lld", (long long) totalSamples);
             textGLWriteString(sampleString, self.windows[windowIndex].windowCoords[0] + nameColumnWidth + 50 + samplesColumnWidth + totalColumnWidth / 2, self.windows[windowIndex].windowCoords[3] - self.windows[windowIndex].windowTop - 25 - (i - 1) * 10, 6, 50);
         }
         double valuesColumnWidth = textGLGetStringLength("Value", 8);
         turtleRectangle(self.windows[windowIndex].windowCoords[0] + nameColumnWidth + 60 + samplesColumnWidth + totalColumnWidth, self.windows[windowIndex].windowCoords[1], self.windows[windowIndex].windowCoords[0] + nameColumnWidth + 80 + samplesColumnWidth + totalColumnWidth + valuesColumnWidth, self.windows[windowIndex].windowCoords[3], self.themeColors[self.theme + 0] - 32, self.themeColors[self.theme + 1] - 32, self.themeColors[self.theme + 2] - 32, 0);
         textGLWriteString("Value", self.windows[windowIndex].windowCoords[0] + nameColumnWidth + 70 + samplesColumnWidth + totalColumnWidth + valuesColumnWidth / 2, self.windows[windowIndex].windowCoords[3] - self.windows[windowIndex].windowTop - 10, 8, 50);
         for (int i = 1; i < self.logVariables -> length; i++) {
-            double value = self.data -> data[i].r -> data[self.data -> data[i].r -> length - 1].d;
+            double value = channel_get(self.data -> data[i].p, ((channel_t *) self.data -> data[i].p) -> length - 1);
             char sampleString[24];
             sprintf(sampleString, "%0.2lf", value);
             textGLWriteString(sampleString, self.windows[windowIndex].windowCoords[0] + nameColumnWidth + 70 + samplesColumnWidth + totalColumnWidth + valuesColumnWidth / 2, self.windows[windowIndex].windowCoords[3] - self.windows[windowIndex].windowTop - 25 - (i - 1) * 10, 6, 50);
@@ -2269,13 +4397,286 @@ void renderInfoData() {
     }
 }
 
+/* restart the cross spectrum average, called when the channels or settings change or Reset is pressed */
+void bodeReset(channel_t *input, channel_t *output, int size, int hop, int averages) {
+    bode_t *bode = &self.bode;
+    bode -> input = input;
+    bode -> output = output;
+    if (bode -> plan != NULL && bode -> size != size) {
+        spectrum_plan_release(bode -> plan);
+        bode -> plan = NULL;
+    }
+    if (bode -> plan == NULL) {
+        bode -> plan = spectrum_plan(size); // held while the size is unchanged, so the cache keeps it
+    }
+    bode -> size = size;
+    bode -> hop = hop;
+    bode -> windowType = bode -> window;
+    bode -> appliedAverages = averages;
+    bode -> windowSum = spectrum_window(spectrum_reserve(&bode -> coefficients, sizeof(float) * size), size, bode -> window);
+    /* line the output up with the input by timestamp, or by their newest samples if either has none */
+    if (input -> anchorLength > 0 && output -> anchorLength > 0 && input -> length > 0) {
+        bode -> offset = llround(channel_index_at(output, channel_time(input, input -> length - 1))) - (input -> length - 1);
+    } else {
+        bode -> offset = output -> length - input -> length;
+    }
+    bode -> next = input -> length - size; // first segment straight away if both channels hold enough
+    bode -> segments = 0;
+    bode -> reset = 0;
+    int bins = size / 2 + 1;
+    double *inputPower = spectrum_reserve(&bode -> inputPower, sizeof(double) * bins);
+    double *outputPower = spectrum_reserve(&bode -> outputPower, sizeof(double) * bins);
+    double *cross = spectrum_reserve(&bode -> cross, sizeof(double) * bins * 2);
+    for (int i = 0; i < bins; i++) {
+        inputPower[i] = 0;
+        outputPower[i] = 0;
+        cross[i * 2] = 0;
+        cross[i * 2 + 1] = 0;
+    }
+}
+
+/* called once per frame on the render thread - transforms every segment of the input and output completed since the last frame and folds them into the cross spectrum average
+at most BODE_MAX_SEGMENTS segments are transformed per frame, if the average falls further behind the oldest ones are skipped */
+void bodeUpdate() {
+    bode_t *bode = &self.bode;
+    if (bode -> inputIndex >= self.data -> length) {
+        bode -> inputIndex = 0;
+    }
+    if (bode -> outputIndex >= self.data -> length) {
+        bode -> outputIndex = 0;
+    }
+    channel_t *input = self.data -> data[bode -> inputIndex].p;
+    channel_t *output = self.data -> data[bode -> outputIndex].p;
+    int size = bodeSizes[bode -> sizeIndex];
+    int hop = round(size * (1 - bode -> overlap / 100));
+    if (hop < 1) {
+        hop = 1;
+    }
+    int averages = round(bode -> averages);
+    bode -> samplesPerSecond = ((logVariable_t *) self.logVariables -> data[bode -> inputIndex].p) -> samplesPerSecond;
+    /* segments pair input and output samples one for one, which only lines up when both are logged at the same rate */
+    double outputRate = ((logVariable_t *) self.logVariables -> data[bode -> outputIndex].p) -> samplesPerSecond;
+    bode -> rateMismatch = bode -> inputIndex > 0 && bode -> outputIndex > 0 && outputRate != bode -> samplesPerSecond;
+    if (bode -> rateMismatch) {
+        bode -> input = NULL; // restart once the rates match
+        bode -> segments = 0;
+        return;
+    }
+    if (input != bode -> input || output != bode -> output || size != bode -> size || hop != bode -> hop || bode -> window != bode -> windowType || averages != bode -> appliedAverages || bode -> reset) {
+        bodeReset(input, output, size, hop, averages);
+    }
+    if (bode -> next < channel_start(input)) {
+        bode -> next = channel_start(input);
+    }
+    if (bode -> next + bode -> offset < channel_start(output)) {
+        bode -> next = channel_start(output) - bode -> offset;
+    }
+    int64_t available = input -> length - bode -> next;
+    if (output -> length - bode -> offset - bode -> next < available) {
+        available = output -> length - bode -> offset - bode -> next;
+    }
+    if (available < size) {
+        return;
+    }
+    int64_t count = (available - size) / hop + 1;
+    if (count > BODE_MAX_SEGMENTS) {
+        bode -> next += (count - BODE_MAX_SEGMENTS) * hop;
+        count = BODE_MAX_SEGMENTS;
+    }
+    int bins = size / 2 + 1;
+    float *samples = spectrum_reserve(&bode -> samples, sizeof(float) * size * 2);
+    kiss_fft_scalar *segment = spectrum_reserve(&bode -> segment, sizeof(kiss_fft_scalar) * size);
+    kiss_fft_cpx *transform = spectrum_reserve(&bode -> bins, sizeof(kiss_fft_cpx) * bins);
+    kiss_fft_cpx *work = spectrum_reserve(&bode -> work, sizeof(kiss_fft_cpx) * (size / 2));
+    float *transforms = spectrum_reserve(&bode -> transforms, sizeof(float) * bins * 4);
+    double *inputPower = spectrum_reserve(&bode -> inputPower, sizeof(double) * bins);
+    double *outputPower = spectrum_reserve(&bode -> outputPower, sizeof(double) * bins);
+    double *cross = spectrum_reserve(&bode -> cross, sizeof(double) * bins * 2);
+    for (int64_t j = 0; j < count; j++) {
+        for (int i = 0; i < size; i++) {
+            samples[i] = channel_get(input, bode -> next + i);
+            samples[size + i] = channel_get(output, bode -> next + bode -> offset + i);
+        }
+        /* input and output share a transform when the FFT runs more than one lane */
+        const float *signals[2] = {samples, samples + size};
+        for (int s = 0; s < 2; s += SPECTRUM_LANES) {
+            int lanes = 2 - s < SPECTRUM_LANES ? 2 - s : SPECTRUM_LANES;
+            spectrum_load(segment, signals + s, lanes, bode -> coefficients.data, size, size);
+            spectrum_rfft(bode -> plan, segment, transform, work);
+            for (int k = 0; k < lanes; k++) {
+                float *bin = transforms + (s + k) * bins * 2;
+                for (int i = 0; i < bins; i++) {
+                    bin[i * 2] = spectrum_lane(transform[i].r, k);
+                    bin[i * 2 + 1] = spectrum_lane(transform[i].i, k);
+                }
+            }
+        }
+        /* equal weights until the average is full, then a fixed weight so it keeps following the system */
+        double weight = 1.0 / (bode -> segments + 1);
+        if (bode -> segments >= averages) {
+            weight = 1.0 / averages;
+        }
+        float *x = transforms;
+        float *y = transforms + bins * 2;
+        for (int i = 0; i < bins; i++) {
+            double xr = x[i * 2];
+            double xi = x[i * 2 + 1];
+            double yr = y[i * 2];
+            double yi = y[i * 2 + 1];
+            inputPower[i] += (xr * xr + xi * xi - inputPower[i]) * weight;
+            outputPower[i] += (yr * yr + yi * yi - outputPower[i]) * weight;
+            /* conj(X) * Y */
+            cross[i * 2] += (xr * yr + xi * yi - cross[i * 2]) * weight;
+            cross[i * 2 + 1] += (xr * yi - xi * yr - cross[i * 2 + 1]) * weight;
+        }
+        bode -> segments++;
+        bode -> next += hop;
+    }
+}
+
+/* transfer function output / input at bin i (H1 estimate, cross spectrum over input power) - magnitude in dB, phase in degrees and coherence */
+void bodeAt(int i, double *magnitude, double *phase, double *coherence) {
+    bode_t *bode = &self.bode;
+    double *inputPower = bode -> inputPower.data;
+    double *outputPower = bode -> outputPower.data;
+    double *cross = bode -> cross.data;
+    double crossPower = cross[i * 2] * cross[i * 2] + cross[i * 2 + 1] * cross[i * 2 + 1];
+    *magnitude = 10 * log10(crossPower / (inputPower[i] * inputPower[i] + 1E-30) + 1E-30);
+    *phase = atan2(cross[i * 2 + 1], cross[i * 2]) * 180 / M_PI;
+    *coherence = crossPower / (inputPower[i] * outputPower[i] + 1E-30);
+}
+
+void renderBodeData() {
+    int windowIndex = ilog2(WINDOW_BODE);
+    int sideAxisWidth = 10;
+    int bottomAxisHeight = 10;
+    bode_t *bode = &self.bode;
+    if (self.windows[windowIndex].minimize) {
+        return;
+    }
+    bodeUpdate();
+    /* render window background */
+    turtleRectangle(self.windows[windowIndex].windowCoords[0], self.windows[windowIndex].windowCoords[1], self.windows[windowIndex].windowCoords[2], self.windows[windowIndex].windowCoords[3], self.themeColors[self.theme + 12], self.themeColors[self.theme + 13], self.themeColors[self.theme + 14], 0);
+    double left = self.windows[windowIndex].windowCoords[0] + sideAxisWidth;
+    double bottom = self.windows[windowIndex].windowCoords[1] + bottomAxisHeight;
+    double right = self.windows[windowIndex].windowCoords[2] - self.windows[windowIndex].windowSide;
+    double top = self.windows[windowIndex].windowCoords[3] - self.windows[windowIndex].windowTop;
+    double middle = (top + bottom) / 2; // magnitude above, phase below
+    int bins = bode -> size / 2 + 1;
+    /* log frequency axis from the first bin to Nyquist */
+    double lowest = log10(bode -> samplesPerSecond / bode -> size);
+    double highest = log10(bode -> samplesPerSecond / 2);
+    double xscale = (right - left) / (highest - lowest);
+    /* render decade lines */
+    for (int decade = ceil(lowest); decade <= highest; decade++) {
+        double x = left + (decade - lowest) * xscale;
+        turtleRectangle(x, bottom, x + 0.5, top, self.themeColors[self.theme + 21], self.themeColors[self.theme + 22], self.themeColors[self.theme + 23], 50);
+        char decadeValue[16];
+        if (decade >= 3) {
+            sprintf(decadeValue, "%gk", pow(10, decade - 3));
+        } else {
+            sprintf(decadeValue, "%g", pow(10, decade));
+        }
+        turtlePenColor(self.themeColors[self.theme + 9], self.themeColors[self.theme + 10], self.themeColors[self.theme + 11]);
+        textGLWriteString(decadeValue, x, self.windows[windowIndex].windowCoords[1] + 5, 6, 50);
+    }
+    turtleRectangle(left, middle - 0.5, right, middle + 0.5, self.themeColors[self.theme + 21], self.themeColors[self.theme + 22], self.themeColors[self.theme + 23], 0);
+    if (bode -> rateMismatch) {
+        char rateMessage[96];
+        sprintf(rateMessage, "Input and output sample rates differ (%g and %g Hz)", bode -> samplesPerSecond, ((logVariable_t *) self.logVariables -> data[bode -> outputIndex].p) -> samplesPerSecond);
+        turtlePenColor(self.themeColors[self.theme + 9], self.themeColors[self.theme + 10], self.themeColors[self.theme + 11]);
+        textGLWriteString(rateMessage, (left + right) / 2, (top + middle) / 2, 7, 50);
+    }
+    if (bode -> segments > 0) {
+        double magnitudeScale = (top - middle) / bode -> range;
+        double phaseScale = (middle - bottom) / 360;
+        /* coherence (0 to 1 over the magnitude pane), then magnitude, then phase - bins closer than half a pixel are skipped */
+        for (int trace = 0; trace < 3; trace++) {
+            if (trace == 0) {
+                turtlePenColor(150, 150, 150);
+            } else {
+                turtlePenColor(self.themeColors[self.theme + 21 + trace * 3], self.themeColors[self.theme + 22 + trace * 3], self.themeColors[self.theme + 23 + trace * 3]);
+            }
+            double lastX = -1000;
+            double lastPhase = 0;
+            for (int i = 1; i < bins; i++) {
+                double x = left + (log10(i * bode -> samplesPerSecond / bode -> size) - lowest) * xscale;
+                if (x - lastX < 0.5) {
+                    continue;
+                }
+                double magnitude;
+                double phase;
+                double coherence;
+                bodeAt(i, &magnitude, &phase, &coherence);
+                double y;
+                if (trace == 0) {
+                    y = middle + coherence * (top - middle);
+                } else if (trace == 1) {
+                    y = middle + fmin(fmax(magnitude - bode -> top + bode -> range, 0), bode -> range) * magnitudeScale;
+                } else {
+                    y = middle - (180 - phase) * phaseScale;
+                    if (fabs(phase - lastPhase) > 180) {
+                        turtlePenUp(); // wrapped around, do not draw a line across the pane
+                    }
+                    lastPhase = phase;
+                }
+                turtleGoto(x, y);
+                turtlePenDown();
+                lastX = x;
+            }
+            turtlePenUp();
+        }
+        /* render mouse */
+        if (self.mx > left && self.mx < right && self.my > bottom && self.my < top) {
+            double frequency = pow(10, lowest + (self.mx - left) / xscale);
+            int bin = round(frequency * bode -> size / bode -> samplesPerSecond);
+            if (bin >= 1 && bin < bins) {
+                double magnitude;
+                double phase;
+                double coherence;
+                bodeAt(bin, &magnitude, &phase, &coherence);
+                double sampleX = left + (log10(bin * bode -> samplesPerSecond / bode -> size) - lowest) * xscale;
+                turtleRectangle(sampleX - 1, top, sampleX + 1, bottom, self.themeColors[self.theme + 21], self.themeColors[self.theme + 22], self.themeColors[self.theme + 23], 100);
+                char sampleValue[64];
+                sprintf(sampleValue, "%.1lfHz %.1lfdB %.0lfdeg coh %.2lf", bin * bode -> samplesPerSecond / bode -> size, magnitude, phase, coherence);
+                double boxLength = textGLGetStringLength(sampleValue, 7);
+                double boxX = sampleX - boxLength / 2;
+                if (boxX - 2 < left) {
+                    boxX = left + 2;
+                }
+                if (boxX + boxLength + 2 > right) {
+                    boxX = right - boxLength - 2;
+                }
+                turtleRectangle(boxX - 2, top - 15, boxX + boxLength + 2, top - 5, 215, 215, 215, 0);
+                turtlePenColor(0, 0, 0);
+                textGLWriteString(sampleValue, boxX, top - 10, 7, 0);
+            }
+        }
+    }
+    /* render side and bottom axis */
+    turtleRectangle(self.windows[windowIndex].windowCoords[0], self.windows[windowIndex].windowCoords[1], left, self.windows[windowIndex].windowCoords[3], self.themeColors[self.theme + 21], self.themeColors[self.theme + 22], self.themeColors[self.theme + 23], 100);
+    turtleRectangle(left, self.windows[windowIndex].windowCoords[1], right, bottom, self.themeColors[self.theme + 21], self.themeColors[self.theme + 22], self.themeColors[self.theme + 23], 100);
+    char axisValue[24];
+    turtlePenColor(self.themeColors[self.theme + 9], self.themeColors[self.theme + 10], self.themeColors[self.theme + 11]);
+    sprintf(axisValue, "%.0lfdB", bode -> top);
+    textGLWriteString(axisValue, left + 2, top - 4, 6, 0);
+    textGLWriteString("180", left + 2, middle - 4, 6, 0);
+    textGLWriteString("-180", left + 2, bottom + 4, 6, 0);
+}
+
 void renderOrder() {
     for (int i = 0; i < self.windowRender -> length; i++) {
         if (self.windowRender -> data[i].i == WINDOW_EDITOR) {
             /* SKIP unfinished EDITOR window */
             continue;
         }
-        if (self.windowRender -> data[i].i >= WINDOW_OSC) {
+        if (self.windowRender -> data[i].i == WINDOW_BODE) {
+            renderBodeData();
+        } else if (self.windowRender -> data[i].i == WINDOW_HARMONIC) {
+            renderHarmonicData();
+        } else if (self.windowRender -> data[i].i == WINDOW_SPECTROGRAM) {
+            renderSpectrogramData();
+        } else if (self.windowRender -> data[i].i >= WINDOW_OSC) {
             renderOscData(ilog2(self.windowRender -> data[i].i) - ilog2(WINDOW_OSC));
         } else if (self.windowRender -> data[i].i >= WINDOW_ORBIT) {
             renderOrbitData(ilog2(self.windowRender -> data[i].i) - ilog2(WINDOW_ORBIT));
@@ -2288,6 +4689,18 @@ void renderOrder() {
         }
         renderWindow(ilog2(self.windowRender -> data[i].i), i == self.windowRender -> length - 1);
     }
+    #ifdef OS_LINUX
+    /* go back to the arrow once no window edge is hovered or being dragged */
+    int resizing = 0;
+    for (int i = 0; i < NUM_WINDOWS; i++) {
+        if (self.windows[i].minimize == 0 && self.windows[i].resize != 0) {
+            resizing = 1;
+        }
+    }
+    if (resizing == 0) {
+        win32SetCursor(CURSOR_POINTER);
+    }
+    #endif
     /* render bottom bar */
     int subtract = 0;
     turtleRectangle(-320, -180, 320, -170, self.themeColors[self.theme + 3], self.themeColors[self.theme + 4], self.themeColors[self.theme + 5], 50);
@@ -2320,7 +4733,7 @@ void saveOsc(char *filename) {
     int oscIndex = 0;
     int windowIndex = 0;
     for (int i = 0; i < self.windowRender -> length; i++) {
-        if (self.windowRender -> data[i].i >= WINDOW_OSC) {
+        if (self.windowRender -> data[i].i >= WINDOW_OSC && self.windowRender -> data[i].i < WINDOW_SPECTROGRAM) {
             oscIndex = ilog2(self.windowRender -> data[i].i) - ilog2(WINDOW_OSC);
             windowIndex = ilog2(WINDOW_OSC) + oscIndex;
         }
@@ -2330,6 +4743,7 @@ void saveOsc(char *filename) {
     double xquantum[4] = {-1, -1, -1, -1};
     double globalQuantum = 10000000.0;
     int iterations = 0;
+    double startTime = -1E300; // rows start where every channel has data
     for (int i = 0; i < 4; i++) {
         int dataIndex = self.osc[oscIndex].dataIndex[i];
         if (dataIndex > 0) {
@@ -2338,24 +4752,25 @@ void saveOsc(char *filename) {
                 globalQuantum = xquantum[i];
                 iterations = self.osc[oscIndex].rightBound[i] - self.osc[oscIndex].leftBound[i];
             }
+            if (oscSampleTime(oscIndex, i, self.osc[oscIndex].leftBound[i]) > startTime) {
+                startTime = oscSampleTime(oscIndex, i, self.osc[oscIndex].leftBound[i]);
+            }
             sprintf(header, "%s%s, ", header, self.logVariables -> data[dataIndex].s);
-            list_append(channels, (unitype) dataIndex, 'i');
-            list_append(channels, (unitype) self.osc[oscIndex].leftBound[i], 'i');
-            list_append(channels, (unitype) xquantum[i], 'd');
+            list_append(channels, (unitype) i, 'i'); // oscilloscope channel
         }
     }
     header[strlen(header) - 2] = '\0';
     fprintf(fp, "%s\n", header);
-    /* linear interpolate */
+    /* linear interpolate, channels are lined up by sample time */
     double timestep = 0.0;
     for (int j = 0; j < iterations; j++) {
         char line[1024];
         sprintf(line, "%lf, ", timestep);
-        for (int i = 0; i < channels -> length / 3; i++) {
-            double preciseIndex = channels -> data[i * 3 + 1].i + timestep / channels -> data[i * 3 + 2].d;
-            double valueLower = self.data -> data[channels -> data[i * 3 + 0].i].r -> data[(int) preciseIndex].d;
-            double valueUpper = self.data -> data[channels -> data[i * 3 + 0].i].r -> data[(int) preciseIndex + 1].d;
-            double value = valueLower + (valueUpper - valueLower) * (preciseIndex - (int) preciseIndex);
+        for (int i = 0; i < channels -> length; i++) {
+            double preciseIndex = oscSampleIndexAtTime(oscIndex, channels -> data[i].i, startTime + timestep / 1000);
+            double valueLower = channel_get(oscChannel(oscIndex, channels -> data[i].i), (int64_t) preciseIndex);
+            double valueUpper = channel_get(oscChannel(oscIndex, channels -> data[i].i), (int64_t) preciseIndex + 1);
+            double value = valueLower + (valueUpper - valueLower) * (preciseIndex - (int64_t) preciseIndex);
             sprintf(line, "%s%lf, ", line, value);
         }
         line[strlen(line) - 2] = '\0';
@@ -2483,7 +4898,7 @@ void utilLoop() {
 
 int main(int argc, char *argv[]) {
     /* hide console */
-    #ifndef DEBUGGING_FLAG
+    #if !defined(DEBUGGING_FLAG) && !defined(OS_LINUX)
     FreeConsole();
     #endif
     GLFWwindow* window;
@@ -2511,11 +4926,17 @@ int main(int argc, char *argv[]) {
     _mkdir("include");
     /* initialise textGL */
     textGLInit(window, "include/fontBez.tgl");
+    /* initialise traceGL (GPU traces) */
+    traceGLInit();
     /* initialise ribbon */
     ribbonInit(window, "include/ribbonConfig.txt");
     ribbonDarkTheme(); // dark theme preset
     /* initialise win32tools */
+    #ifdef OS_LINUX
+    zenityFileDialogInit(argv[0]);
+    #else
     win32ToolsInit();
+    #endif
     win32FileDialogAddExtension("csv"); // add csv to extension restrictions
 
     int tps = 120; // ticks per second (locked to fps in this case)
@@ -2594,15 +5015,19 @@ int main(int argc, char *argv[]) {
             double sinValue1 = sin(tick / 5.0) * 25;
             double sinValue2 = sin(tick / 3.37) * 25;
             double sinValue3 = sin(tick * 1.1) * 12.5;
-            list_append(self.data -> data[1].r, (unitype) (sinValue1), 'd');
-            list_append(self.data -> data[2].r, (unitype) (sin(tick / 5.0 + M_PI / 3 * 2) * 25), 'd');
-            list_append(self.data -> data[2].r, (unitype) (sin((tick + 0.5) / 5.0 + M_PI / 3 * 2) * 25), 'd');
-            list_append(self.data -> data[3].r, (unitype) (sin(tick / 5.0 + M_PI / 3 * 4) * 25), 'd');
-            list_append(self.data -> data[4].r, (unitype) (sin(tick / 5.0 + M_PI / 2) * 25), 'd');
+            channel_append(self.data -> data[1].p, sinValue1);
+            channel_append(self.data -> data[2].p, sin(tick / 5.0 + M_PI / 3 * 2) * 25);
+            channel_append(self.data -> data[2].p, sin((tick + 0.5) / 5.0 + M_PI / 3 * 2) * 25);
+            channel_append(self.data -> data[3].p, sin(tick / 5.0 + M_PI / 3 * 4) * 25);
+            channel_append(self.data -> data[4].p, sin(tick / 5.0 + M_PI / 2) * 25);
         }
+        commsDrainQueues();
+        triggerIngest();
+        harmonicIngest();
         utilLoop();
         turtleGetMouseCoords(); // get the mouse coordinates (turtle.mouseX, turtle.mouseY)
         turtleClear();
+        traceGLClear();
         renderOrder();
         ribbonUpdate();
         parseRibbonOutput();
@@ -2620,6 +5045,7 @@ int main(int argc, char *argv[]) {
         }
         tick++;
     }
+    freqThreadStop();
     turtleFree();
     glfwTerminate();
     return 0;
@@ -0,0 +1,392 @@
+/*
+fixed capacity ring buffer of samples, addressed by absolute sample index
+
+samples are stored contiguously as sample_t - float (4 bytes, same as the AMDC sends) unless compiled with -DCHANNEL_DOUBLE
+a channel only holds samples, everything else about the variable (name, slot, rate) is kept by the caller
+
+samples are numbered from 0 in the order they were appended, forever
+once more than capacity samples have been appended the oldest ones are overwritten, so only indices in [channel_start(channel), channel -> length) can be read
+
+create channel (capacity is rounded up to a power of two):
+channel_t *channel = channel_init([capacity]);
+
+append a sample:
+channel_append(channel, [value]);
+
+append a sample with a timestamp (any integer unit, must not go backwards):
+channel_append_timed(channel, [value], [time]);
+
+timestamps are kept as sparse anchors - one every CHANNEL_ANCHOR_SPACING samples, plus a pair around every gap or rate change
+time is linear between consecutive anchors, so both lookups below are a binary search over the anchors
+
+check if the channel has timestamps:
+channel -> anchorLength > 0
+
+time of a sample (same unit as the timestamps, extrapolated past the newest sample):
+double time = channel_time(channel, [index]);
+
+fractional absolute index at a time (floor it to get the last sample at or before that time):
+double index = channel_index_at(channel, [time]);
+
+every channel also keeps a min/max pyramid, updated as samples are appended
+level L (1 to CHANNEL_LOD_LEVELS) summarises buckets of channel_lod_size(L) samples, bucket b covers absolute indices [b * size, (b + 1) * size)
+
+deepest level whose buckets are at most samplesPerBucket samples (0 means read raw samples):
+int level = channel_lod_level(channel, [samplesPerBucket]);
+
+min and max of a bucket:
+channel_lod_get(channel, [level], [bucket], &min, &max);
+
+read a sample by absolute index (indices outside the retained range are clamped to it, an empty channel reads 0):
+sample_t value = channel_get(channel, [index]);
+
+total number of samples ever appended (absolute index of the next sample):
+channel -> length
+
+oldest retained absolute index:
+channel_start(channel);
+
+replace a channel's contents with samples [first, end) of another, kept at the same absolute indices and with their timestamps (grows the capacity if needed):
+channel_copy([destination], [source], [first], [end]);
+
+change the capacity (keeps the most recent samples):
+channel_resize(channel, [capacity]);
+
+free the channel (when done using):
+channel_free(channel);
+*/
+
+#ifndef CHANNELSET
+#define CHANNELSET 1 // include guard
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#ifdef CHANNEL_DOUBLE
+typedef double sample_t;
+#else
+typedef float sample_t;
+#endif
+
+#define CHANNEL_ANCHOR_SPACING   1024 // at most this many samples between anchors
+#define CHANNEL_JITTER_TOLERANCE 0.25 // fraction of a sample period a timestamp may stray from the current segment before it starts a new one
+
+#define CHANNEL_LOD_LEVELS       8 // levels of the min/max pyramid
+#define CHANNEL_LOD_SHIFT        2 // each level's buckets are 2^CHANNEL_LOD_SHIFT times the size of the level below
+
+typedef struct {
+    sample_t *min;
+    sample_t *max;
+    int64_t mask; // ring capacity - 1, in buckets
+} channel_lod_t;
+
+typedef struct {
+    int64_t index; // absolute sample index
+    int64_t time; // timestamp of that sample
+} channel_anchor_t;
+
+typedef struct {
+    sample_t *data;
+    int64_t capacity; // always a power of two
+    int64_t mask;
+    int64_t length; // total samples ever appended
+    int64_t oldest; // nothing before this index survived the last resize
+    channel_anchor_t *anchors; // ring of anchors, NULL until the first timed sample
+    int64_t anchorCapacity; // always a power of two
+    int64_t anchorStart; // absolute number of the oldest anchor kept
+    int64_t anchorLength; // total anchors ever added
+    int64_t lastTime; // timestamp of the newest sample
+    channel_lod_t lod[CHANNEL_LOD_LEVELS + 1]; // min/max pyramid, lod[0] is unused (level 0 is the samples themselves)
+} channel_t;
+
+int64_t channel_round_capacity(int64_t capacity) {
+    int64_t realCapacity = 1;
+    while (realCapacity < capacity) {
+        realCapacity <<= 1;
+    }
+    return realCapacity;
+}
+
+int64_t channel_lod_size(int level) {
+    return (int64_t) 1 << (level * CHANNEL_LOD_SHIFT);
+}
+
+/* allocate the pyramid for the current capacity, twice the buckets needed so the partial oldest bucket is never shared with the newest */
+void channel_lod_alloc(channel_t *channel) {
+    for (int level = 1; level <= CHANNEL_LOD_LEVELS; level++) {
+        int64_t buckets = (channel -> capacity >> (level * CHANNEL_LOD_SHIFT)) * 2;
+        if (buckets < 2) {
+            buckets = 2;
+        }
+        channel -> lod[level].min = malloc(buckets * sizeof(sample_t));
+        channel -> lod[level].max = malloc(buckets * sizeof(sample_t));
+        channel -> lod[level].mask = buckets - 1;
+    }
+}
+
+void channel_lod_free(channel_t *channel) {
+    for (int level = 1; level <= CHANNEL_LOD_LEVELS; level++) {
+        free(channel -> lod[level].min);
+        free(channel -> lod[level].max);
+    }
+}
+
+/* fold one sample into every level, first is the oldest index being folded in (a bucket starting there has no earlier samples) */
+void channel_lod_update(channel_t *channel, int64_t index, sample_t value, int64_t first) {
+    for (int level = 1; level <= CHANNEL_LOD_LEVELS; level++) {
+        int shift = level * CHANNEL_LOD_SHIFT;
+        channel_lod_t *lod = &channel -> lod[level];
+        int64_t slot = (index >> shift) & lod -> mask;
+        if ((index & (((int64_t) 1 << shift) - 1)) == 0 || index == first) {
+            /* first sample of a new bucket */
+            lod -> min[slot] = value;
+            lod -> max[slot] = value;
+        } else {
+            if (value < lod -> min[slot]) {
+                lod -> min[slot] = value;
+            }
+            if (value > lod -> max[slot]) {
+                lod -> max[slot] = value;
+            }
+        }
+    }
+}
+
+int channel_lod_level(channel_t *channel, double samplesPerBucket) {
+    int level = 0;
+    while (level < CHANNEL_LOD_LEVELS && channel_lod_size(level + 1) <= samplesPerBucket) {
+        level++;
+    }
+    return level;
+}
+
+void channel_lod_get(channel_t *channel, int level, int64_t bucket, double *min, double *max) {
+    channel_lod_t *lod = &channel -> lod[level];
+    *min = lod -> min[bucket & lod -> mask];
+    *max = lod -> max[bucket & lod -> mask];
+}
+
+channel_t *channel_init(int64_t capacity) {
+    channel_t *channel = malloc(sizeof(channel_t));
+    channel -> capacity = channel_round_capacity(capacity);
+    channel -> mask = channel -> capacity - 1;
+    channel -> data = calloc(channel -> capacity, sizeof(sample_t));
+    channel -> length = 0;
+    channel -> oldest = 0;
+    channel -> anchors = NULL;
+    channel -> anchorCapacity = 0;
+    channel -> anchorStart = 0;
+    channel -> anchorLength = 0;
+    channel -> lastTime = 0;
+    channel_lod_alloc(channel);
+    return channel;
+}
+
+void channel_append(channel_t *channel, sample_t value) {
+    channel -> data[channel -> length & channel -> mask] = value;
+    channel_lod_update(channel, channel -> length, value, 0);
+    channel -> length++;
+}
+
+int64_t channel_start(channel_t *channel) {
+    if (channel -> length - channel -> capacity > channel -> oldest) {
+        return channel -> length - channel -> capacity;
+    }
+    return channel -> oldest;
+}
+
+channel_anchor_t *channel_anchor(channel_t *channel, int64_t anchorIndex) {
+    return &channel -> anchors[anchorIndex & (channel -> anchorCapacity - 1)];
+}
+
+void channel_add_anchor(channel_t *channel, int64_t index, int64_t time) {
+    if (channel -> anchorLength - channel -> anchorStart == channel -> anchorCapacity) {
+        /* forget anchors for overwritten samples, keeping one at or before the oldest retained sample */
+        int64_t start = channel_start(channel);
+        while (channel -> anchorLength - channel -> anchorStart > 1 && channel_anchor(channel, channel -> anchorStart + 1) -> index <= start) {
+            channel -> anchorStart++;
+        }
+    }
+    if (channel -> anchorLength - channel -> anchorStart == channel -> anchorCapacity) {
+        int64_t newCapacity = channel -> anchorCapacity == 0 ? 64 : channel -> anchorCapacity * 2;
+        channel_anchor_t *newAnchors = malloc(newCapacity * sizeof(channel_anchor_t));
+        for (int64_t i = channel -> anchorStart; i < channel -> anchorLength; i++) {
+            newAnchors[i & (newCapacity - 1)] = *channel_anchor(channel, i);
+        }
+        free(channel -> anchors);
+        channel -> anchors = newAnchors;
+        channel -> anchorCapacity = newCapacity;
+    }
+    channel_anchor_t *anchor = channel_anchor(channel, channel -> anchorLength);
+    anchor -> index = index;
+    anchor -> time = time;
+    channel -> anchorLength++;
+}
+
+void channel_append_timed(channel_t *channel, sample_t value, int64_t time) {
+    if (channel -> anchorLength == 0) {
+        channel_add_anchor(channel, channel -> length, time);
+    } else {
+        channel_anchor_t *last = channel_anchor(channel, channel -> anchorLength - 1);
+        int64_t newest = channel -> length - 1;
+        if (last -> index < newest) {
+            /* compare against where the current segment predicts this sample */
+            double period = (double) (channel -> lastTime - last -> time) / (newest - last -> index);
+            double predicted = last -> time + period * (channel -> length - last -> index);
+            if (fabs(time - predicted) > period * CHANNEL_JITTER_TOLERANCE) {
+                /* gap or rate change - close the old segment at the previous sample and start a new one here */
+                channel_add_anchor(channel, newest, channel -> lastTime);
+                channel_add_anchor(channel, channel -> length, time);
+            } else if (channel -> length - last -> index >= CHANNEL_ANCHOR_SPACING) {
+                channel_add_anchor(channel, channel -> length, time);
+            }
+        }
+    }
+    channel -> lastTime = time;
+    channel_append(channel, value);
+}
+
+/* last anchor whose field (index or time) is <= value, or anchorStart if none */
+int64_t channel_find_anchor(channel_t *channel, double value, char byTime) {
+    int64_t low = channel -> anchorStart;
+    int64_t high = channel -> anchorLength - 1;
+    while (low < high) {
+        int64_t mid = low + (high - low + 1) / 2;
+        channel_anchor_t *anchor = channel_anchor(channel, mid);
+        if ((byTime ? anchor -> time : anchor -> index) <= value) {
+            low = mid;
+        } else {
+            high = mid - 1;
+        }
+    }
+    return low;
+}
+
+/* the segment from anchor to the next anchor (or to the newest sample), as a start point and a time per sample */
+double channel_segment(channel_t *channel, int64_t anchorIndex, channel_anchor_t *start) {
+    *start = *channel_anchor(channel, anchorIndex);
+    if (anchorIndex + 1 < channel -> anchorLength) {
+        channel_anchor_t *next = channel_anchor(channel, anchorIndex + 1);
+        return (double) (next -> time - start -> time) / (next -> index - start -> index);
+    }
+    if (channel -> length - 1 > start -> index) {
+        return (double) (channel -> lastTime - start -> time) / (channel -> length - 1 - start -> index);
+    }
+    if (anchorIndex > channel -> anchorStart) {
+        channel_anchor_t *previous = channel_anchor(channel, anchorIndex - 1);
+        return (double) (start -> time - previous -> time) / (start -> index - previous -> index);
+    }
+    return 0;
+}
+
+double channel_time(channel_t *channel, int64_t index) {
+    if (channel -> anchorLength == 0) {
+        return 0;
+    }
+    channel_anchor_t start;
+    double period = channel_segment(channel, channel_find_anchor(channel, index, 0), &start);
+    return start.time + period * (index - start.index);
+}
+
+double channel_index_at(channel_t *channel, double time) {
+    if (channel -> anchorLength == 0) {
+        return 0;
+    }
+    channel_anchor_t start;
+    double period = channel_segment(channel, channel_find_anchor(channel, time, 1), &start);
+    if (period <= 0) {
+        return start.index;
+    }
+    return start.index + (time - start.time) / period;
+}
+
+sample_t channel_get(channel_t *channel, int64_t index) {
+    if (channel -> length == 0) {
+        return 0;
+    }
+    if (index >= channel -> length) {
+        index = channel -> length - 1;
+    }
+    int64_t start = channel_start(channel);
+    if (index < start) {
+        index = start;
+    }
+    return channel -> data[index & channel -> mask];
+}
+
+void channel_resize(channel_t *channel, int64_t capacity) {
+    capacity = channel_round_capacity(capacity);
+    if (capacity == channel -> capacity) {
+        return;
+    }
+    sample_t *newData = calloc(capacity, sizeof(sample_t));
+    int64_t start = channel -> length - capacity;
+    if (start < channel_start(channel)) {
+        start = channel_start(channel);
+    }
+    for (int64_t i = start; i < channel -> length; i++) {
+        newData[i & (capacity - 1)] = channel -> data[i & channel -> mask];
+    }
+    free(channel -> data);
+    channel -> data = newData;
+    channel -> capacity = capacity;
+    channel -> mask = capacity - 1;
+    channel -> oldest = start;
+    /* rebuild the pyramid from the samples kept */
+    channel_lod_free(channel);
+    channel_lod_alloc(channel);
+    for (int64_t i = start; i < channel -> length; i++) {
+        channel_lod_update(channel, i, channel -> data[i & channel -> mask], start);
+    }
+}
+
+void channel_copy(channel_t *destination, channel_t *source, int64_t first, int64_t end) {
+    if (first < channel_start(source)) {
+        first = channel_start(source);
+    }
+    if (end > source -> length) {
+        end = source -> length;
+    }
+    if (end < first) {
+        end = first;
+    }
+    if (destination -> capacity < end - first) {
+        free(destination -> data);
+        channel_lod_free(destination);
+        destination -> capacity = channel_round_capacity(end - first);
+        destination -> mask = destination -> capacity - 1;
+        destination -> data = calloc(destination -> capacity, sizeof(sample_t));
+        channel_lod_alloc(destination);
+    }
+    destination -> oldest = first;
+    for (int64_t i = first; i < end; i++) {
+        destination -> data[i & destination -> mask] = source -> data[i & source -> mask];
+        channel_lod_update(destination, i, destination -> data[i & destination -> mask], first);
+    }
+    destination -> length = end;
+    /* the anchors at or before first through the first one at or after the last sample keep every segment's rate exact */
+    destination -> anchorStart = 0;
+    destination -> anchorLength = 0;
+    destination -> lastTime = 0;
+    if (source -> anchorLength > 0 && end > first) {
+        for (int64_t anchorIndex = channel_find_anchor(source, first, 0); anchorIndex < source -> anchorLength; anchorIndex++) {
+            channel_anchor_t *anchor = channel_anchor(source, anchorIndex);
+            channel_add_anchor(destination, anchor -> index, anchor -> time);
+            if (anchor -> index >= end - 1) {
+                break;
+            }
+        }
+        destination -> lastTime = round(channel_time(source, end - 1));
+    }
+}
+
+void channel_free(channel_t *channel) {
+    channel_lod_free(channel);
+    free(channel -> anchors);
+    free(channel -> data);
+    free(channel);
+}
+
+#endif
@@ -0,0 +1,151 @@
+/*
+harmonic tracker - amplitude and phase of the first N harmonics of a fundamental, updated with every sample instead of from a full spectrum
+
+each harmonic is one DFT bin slid along the signal (the sliding Goertzel): every sample adds value * e^(-j h phase) to a running sum and the sample that leaves the window takes its term back out
+the fundamental's phase is given with every sample, so the bins follow a fundamental that changes (from a speed or angle signal) as well as a fixed one
+for a fixed fundamental this is the same bin the Goertzel filter evaluates, a window holding a whole number of cycles keeps the harmonics from leaking into each other
+
+create a tracker of [harmonics] (at most HARMONIC_MAX) over a window of [window] samples:
+harmonic_t tracker;
+harmonic_init(&tracker, [harmonics], [window]);
+
+add a sample and the phase of the fundamental at that sample (radians, not wrapped - keep adding 2 pi every cycle):
+harmonic_push(&tracker, [value], [phase]);
+
+amplitude and phase (radians, relative to the fundamental's phase) of harmonic h (1 to harmonics) over the samples in the window:
+double amplitude = harmonic_amplitude(&tracker, [h]);
+double phase = harmonic_phase(&tracker, [h]);
+
+fundamental frequency over the window, from how far its phase advanced (same unit as samplesPerSecond, 0 until the window has two samples):
+double frequency = harmonic_frequency(&tracker, [samplesPerSecond]);
+
+the window is full once tracker.count == tracker.window, before that the results cover the samples pushed so far
+
+forget every sample pushed (keeps the harmonics and window):
+harmonic_clear(&tracker);
+
+free the tracker (when done using):
+harmonic_free(&tracker);
+
+a push costs one sincos and harmonics complex multiplies for the new sample and the same for the one leaving the window
+the running sums are recomputed from the window every window samples so rounding does not build up
+*/
+
+#ifndef HARMONICSET
+#define HARMONICSET 1 // include guard
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+
+#define HARMONIC_MAX 16
+
+typedef struct {
+    int harmonics;
+    int window; // samples in a full window
+    float *values; // last window samples and their fundamental phases, a ring starting at head
+    double *phases;
+    int head; // oldest sample in the ring
+    int count; // samples in the ring
+    int sinceResync; // pushes since the sums were recomputed
+    double sum[HARMONIC_MAX][2]; // running sum of value * e^(-j h phase) for each harmonic (real, imaginary)
+} harmonic_t;
+
+void harmonic_clear(harmonic_t *tracker) {
+    tracker -> head = 0;
+    tracker -> count = 0;
+    tracker -> sinceResync = 0;
+    for (int i = 0; i < HARMONIC_MAX; i++) {
+        tracker -> sum[i][0] = 0;
+        tracker -> sum[i][1] = 0;
+    }
+}
+
+void harmonic_init(harmonic_t *tracker, int harmonics, int window) {
+    if (harmonics > HARMONIC_MAX) {
+        harmonics = HARMONIC_MAX;
+    }
+    if (window < 2) {
+        window = 2;
+    }
+    tracker -> harmonics = harmonics;
+    tracker -> window = window;
+    tracker -> values = malloc(sizeof(float) * window);
+    tracker -> phases = malloc(sizeof(double) * window);
+    harmonic_clear(tracker);
+}
+
+/* add (sign 1) or take out (sign -1) the terms of one sample, the powers of e^(-j phase) are built by repeated multiplication */
+void harmonic_accumulate(harmonic_t *tracker, double value, double phase, double sign) {
+    double baseReal = cos(phase);
+    double baseImaginary = -sin(phase);
+    double real = value * sign;
+    double imaginary = 0;
+    for (int i = 0; i < tracker -> harmonics; i++) {
+        double nextReal = real * baseReal - imaginary * baseImaginary;
+        imaginary = real * baseImaginary + imaginary * baseReal;
+        real = nextReal;
+        tracker -> sum[i][0] += real;
+        tracker -> sum[i][1] += imaginary;
+    }
+}
+
+void harmonic_push(harmonic_t *tracker, double value, double phase) {
+    int slot;
+    if (tracker -> count == tracker -> window) {
+        harmonic_accumulate(tracker, tracker -> values[tracker -> head], tracker -> phases[tracker -> head], -1);
+        slot = tracker -> head;
+        tracker -> head = (tracker -> head + 1) % tracker -> window;
+    } else {
+        slot = (tracker -> head + tracker -> count) % tracker -> window;
+        tracker -> count++;
+    }
+    tracker -> values[slot] = value;
+    tracker -> phases[slot] = phase;
+    harmonic_accumulate(tracker, value, phase, 1);
+    tracker -> sinceResync++;
+    if (tracker -> sinceResync >= tracker -> window) {
+        for (int i = 0; i < HARMONIC_MAX; i++) {
+            tracker -> sum[i][0] = 0;
+            tracker -> sum[i][1] = 0;
+        }
+        for (int i = 0; i < tracker -> count; i++) {
+            int index = (tracker -> head + i) % tracker -> window;
+            harmonic_accumulate(tracker, tracker -> values[index], tracker -> phases[index], 1);
+        }
+        tracker -> sinceResync = 0;
+    }
+}
+
+double harmonic_amplitude(harmonic_t *tracker, int harmonic) {
+    if (tracker -> count == 0 || harmonic < 1 || harmonic > tracker -> harmonics) {
+        return 0;
+    }
+    /* a cosine of amplitude A at the harmonic sums to A / 2 per sample */
+    return 2 * hypot(tracker -> sum[harmonic - 1][0], tracker -> sum[harmonic - 1][1]) / tracker -> count;
+}
+
+double harmonic_phase(harmonic_t *tracker, int harmonic) {
+    if (tracker -> count == 0 || harmonic < 1 || harmonic > tracker -> harmonics) {
+        return 0;
+    }
+    return atan2(tracker -> sum[harmonic - 1][1], tracker -> sum[harmonic - 1][0]);
+}
+
+double harmonic_frequency(harmonic_t *tracker, double samplesPerSecond) {
+    if (tracker -> count < 2) {
+        return 0;
+    }
+    double oldest = tracker -> phases[tracker -> head];
+    double newest = tracker -> phases[(tracker -> head + tracker -> count - 1) % tracker -> window];
+    return (newest - oldest) / (2 * M_PI) * samplesPerSecond / (tracker -> count - 1);
+}
+
+void harmonic_free(harmonic_t *tracker) {
+    free(tracker -> values);
+    free(tracker -> phases);
+    tracker -> values = NULL;
+    tracker -> phases = NULL;
+}
+
+#endif
@@ -0,0 +1,176 @@
+/*
+point grid - nearest point lookup over a sliding run of 2D points, points are added at the new end and taken out at the old end
+
+the points are hashed into the cells of a uniform grid, a lookup only visits the cells around the query point, growing outward until no closer point can be left
+points are numbered by the caller (consecutive int64_t indices, like absolute channel indices) and only the last capacity of them can be held at once
+
+create a grid holding up to [capacity] points with cells [cellX] by [cellY] (in point units):
+pointgrid_t grid;
+pointgrid_init(&grid, [capacity], [cellX], [cellY]);
+
+add the point after the newest one (index grid.last), and take out the oldest one (index grid.first):
+pointgrid_push(&grid, [x], [y]);
+pointgrid_pop(&grid);
+
+forget every point and start again at index [first], with new cell sizes:
+pointgrid_reset(&grid, [first], [cellX], [cellY]);
+
+index of the point nearest to (x, y), -1 if there is none within sqrt(maxDistanceSquared)
+distances are measured after scaling x by [scaleX] and y by [scaleY] (pixels per point unit, so the nearest point on screen is found):
+double distanceSquared;
+int64_t index = pointgrid_nearest(&grid, [x], [y], [scaleX], [scaleY], [maxDistanceSquared], &distanceSquared);
+
+free the grid (when done using):
+pointgrid_free(&grid);
+
+each cell keeps its points oldest first, so a pop takes the head of one cell and a push appends to the tail of one cell
+cells share POINTGRID_BUCKETS hash buckets, a bucket holding more than one cell only costs extra distance checks
+*/
+
+#ifndef POINTGRIDSET
+#define POINTGRIDSET 1 // include guard
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+
+#define POINTGRID_BUCKETS 4096 // power of two
+#define POINTGRID_MAX_RINGS 32 // rings of cells searched before a lookup falls back to checking every point
+
+typedef struct {
+    int64_t capacity;
+    double cellX; // cell size
+    double cellY;
+    int64_t first; // oldest point held
+    int64_t last; // one past the newest point held
+    double *x; // points, slot index % capacity
+    double *y;
+    int64_t *next; // next point in the same bucket, -1 at the tail
+    int *bucket; // bucket of each point
+    int64_t head[POINTGRID_BUCKETS]; // oldest point in each bucket, -1 if empty
+    int64_t tail[POINTGRID_BUCKETS]; // newest point in each bucket
+} pointgrid_t;
+
+void pointgrid_reset(pointgrid_t *grid, int64_t first, double cellX, double cellY) {
+    grid -> cellX = cellX;
+    grid -> cellY = cellY;
+    grid -> first = first;
+    grid -> last = first;
+    for (int i = 0; i < POINTGRID_BUCKETS; i++) {
+        grid -> head[i] = -1;
+        grid -> tail[i] = -1;
+    }
+}
+
+void pointgrid_init(pointgrid_t *grid, int64_t capacity, double cellX, double cellY) {
+    grid -> capacity = capacity;
+    grid -> x = malloc(sizeof(double) * capacity);
+    grid -> y = malloc(sizeof(double) * capacity);
+    grid -> next = malloc(sizeof(int64_t) * capacity);
+    grid -> bucket = malloc(sizeof(int) * capacity);
+    pointgrid_reset(grid, 0, cellX, cellY);
+}
+
+/* cell coordinate of a value, NaN and values too far out to hold in an int64_t go to cell 0 */
+int64_t pointgrid_cell(double value, double cell) {
+    double index = floor(value / cell);
+    if (!(fabs(index) < 1E15)) {
+        return 0;
+    }
+    return (int64_t) index;
+}
+
+int pointgrid_hash(int64_t cellX, int64_t cellY) {
+    return (int) (((uint64_t) cellX * 73856093u ^ (uint64_t) cellY * 19349663u) & (POINTGRID_BUCKETS - 1));
+}
+
+void pointgrid_pop(pointgrid_t *grid) {
+    if (grid -> first == grid -> last) {
+        return;
+    }
+    int64_t slot = grid -> first % grid -> capacity;
+    int bucket = grid -> bucket[slot];
+    /* the oldest point held is always the head of its bucket */
+    grid -> head[bucket] = grid -> next[slot];
+    if (grid -> head[bucket] == -1) {
+        grid -> tail[bucket] = -1;
+    }
+    grid -> first++;
+}
+
+void pointgrid_push(pointgrid_t *grid, double x, double y) {
+    if (grid -> last - grid -> first == grid -> capacity) {
+        pointgrid_pop(grid);
+    }
+    int64_t index = grid -> last;
+    int64_t slot = index % grid -> capacity;
+    int bucket = pointgrid_hash(pointgrid_cell(x, grid -> cellX), pointgrid_cell(y, grid -> cellY));
+    grid -> x[slot] = x;
+    grid -> y[slot] = y;
+    grid -> next[slot] = -1;
+    grid -> bucket[slot] = bucket;
+    if (grid -> tail[bucket] == -1) {
+        grid -> head[bucket] = index;
+    } else {
+        grid -> next[grid -> tail[bucket] % grid -> capacity] = index;
+    }
+    grid -> tail[bucket] = index;
+    grid -> last++;
+}
+
+/* distance from (x, y) to the point at index, keeps it if it is the closest so far (ties go to the newest point) */
+void pointgrid_consider(pointgrid_t *grid, int64_t index, double x, double y, double scaleX, double scaleY, int64_t *closest, double *best) {
+    int64_t slot = index % grid -> capacity;
+    double xDistance = (grid -> x[slot] - x) * scaleX;
+    double yDistance = (grid -> y[slot] - y) * scaleY;
+    double distance = xDistance * xDistance + yDistance * yDistance;
+    if (distance < *best || (distance == *best && *closest != -1 && index > *closest)) {
+        *best = distance;
+        *closest = index;
+    }
+}
+
+int64_t pointgrid_nearest(pointgrid_t *grid, double x, double y, double scaleX, double scaleY, double maxDistanceSquared, double *distanceSquared) {
+    int64_t closest = -1;
+    double best = maxDistanceSquared;
+    int64_t centerX = pointgrid_cell(x, grid -> cellX);
+    int64_t centerY = pointgrid_cell(y, grid -> cellY);
+    /* every point not yet visited at ring r (outside ring r - 1) is at least r - 1 cells away on one axis */
+    double cellSize = fmin(fabs(grid -> cellX * scaleX), fabs(grid -> cellY * scaleY));
+    for (int64_t ring = 0; grid -> first < grid -> last && (ring == 0 || ((ring - 1) * cellSize) * ((ring - 1) * cellSize) < best); ring++) {
+        if (ring > POINTGRID_MAX_RINGS) {
+            /* cells are too small for the distance asked for, check every point instead */
+            for (int64_t index = grid -> first; index < grid -> last; index++) {
+                pointgrid_consider(grid, index, x, y, scaleX, scaleY, &closest, &best);
+            }
+            break;
+        }
+        for (int64_t i = -ring; i <= ring; i++) {
+            /* top and bottom rows of the ring, then just the two ends of the rows between */
+            int64_t step = (i == -ring || i == ring) ? 1 : ring * 2;
+            for (int64_t j = -ring; j <= ring; j += step) {
+                int bucket = pointgrid_hash(centerX + i, centerY + j);
+                for (int64_t index = grid -> head[bucket]; index != -1; index = grid -> next[index % grid -> capacity]) {
+                    pointgrid_consider(grid, index, x, y, scaleX, scaleY, &closest, &best);
+                }
+            }
+        }
+    }
+    if (closest != -1 && distanceSquared != NULL) {
+        *distanceSquared = best;
+    }
+    return closest;
+}
+
+void pointgrid_free(pointgrid_t *grid) {
+    free(grid -> x);
+    free(grid -> y);
+    free(grid -> next);
+    free(grid -> bucket);
+    grid -> x = NULL;
+    grid -> y = NULL;
+    grid -> next = NULL;
+    grid -> bucket = NULL;
+}
+
+#endif
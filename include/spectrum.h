@@ -0,0 +1,312 @@
+/*
+real-input FFT (the kiss_fftr algorithm on top of kissFFT.h) with a cache of plans keyed by length
+
+a real transform of even length n runs one complex kissFFT of n / 2 points and untangles the result, about half the work of transforming n complex points
+
+plan for an even length (built the first time a length is asked for, reused after that), the cache can be shared between threads:
+spectrum_plan_t *plan = spectrum_plan([length]);
+...
+spectrum_plan_release(plan);
+
+transform length real samples into length / 2 + 1 complex bins (DC to Nyquist), work must hold length / 2 complex values:
+spectrum_rfft(plan, [samples], [bins], [work]);
+
+built with USE_SIMD (kissFFT's SSE path) every kiss_fft_scalar holds SPECTRUM_LANES floats and one transform runs four independent signals, one per lane
+otherwise SPECTRUM_LANES is 1 and the same calls run one signal
+
+window up to SPECTRUM_LANES float signals into the lanes of a transform input, zero padded to length samples (unused lanes are zero):
+const float *signals[SPECTRUM_LANES] = {...};
+spectrum_load([input], signals, [lanes], [window], [windowLength], [length]);
+
+power of every bin of every lane, power[bin * SPECTRUM_LANES + lane]:
+spectrum_power([power], [bins], [count]);
+
+fill a window function, returns the sum of its coefficients (sinusoid of amplitude A lands in its bin with magnitude A * sum / 2):
+double sum = spectrum_window([coefficients], [length], SPECTRUM_WINDOW_HANN);
+
+fold one lane of spectrum_power into a running average, weight 1 / (n + 1) gives the mean of n + 1 transforms and a fixed weight an exponential average:
+spectrum_average([average], [power], [count], [lane], [weight]);
+
+amplitude spectrum of an averaged power, sqrt(power) * 2 / windowSum (DC and Nyquist are not doubled):
+spectrum_magnitude([magnitude], [average], [count], [length], [windowSum]);
+
+one float of a lane, for reading the phase out of a transform:
+float value = spectrum_lane(bins[i].r, [lane]);
+
+heap buffers aligned to SPECTRUM_ALIGN bytes, reused across calls and only reallocated when they need to grow:
+spectrum_buffer_t buffer = {NULL, 0};
+float *data = spectrum_reserve(&buffer, [bytes]);
+
+the cache keeps the SPECTRUM_PLAN_CACHE most recently used lengths that are not in use, a plan is only freed once every spectrum_plan has been matched by a release
+
+free every cached plan:
+spectrum_cleanup();
+*/
+
+#ifndef SPECTRUMSET
+#define SPECTRUMSET 1 // include guard
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+/* kissFFT.h has no include guard of its own, include it before this file */
+
+#define SPECTRUM_PLAN_CACHE 16
+#define SPECTRUM_ALIGN 64
+
+#ifdef USE_SIMD
+#define SPECTRUM_LANES 4 // floats in a kiss_fft_scalar
+#else
+#define SPECTRUM_LANES 1
+#endif
+
+enum spectrum_window {
+    SPECTRUM_WINDOW_TAPER = 0, // linear ramps over the first and last 10%
+    SPECTRUM_WINDOW_HANN,
+    SPECTRUM_WINDOW_BLACKMAN_HARRIS, // 4 term, -92dB sidelobes
+    SPECTRUM_WINDOW_FLAT_TOP // 5 term, flat passband for amplitude readings
+};
+
+typedef struct {
+    int length; // real samples in
+    kiss_fft_cfg half; // complex transform of length / 2
+    kiss_fft_cpx *twiddles; // length / 4 twiddles that untangle the half length transform
+    uint64_t used; // last use, for eviction
+    int users; // spectrum_plan calls not yet released, the plan is not evicted while this is above 0
+} spectrum_plan_t;
+
+typedef struct {
+    void *data;
+    size_t size;
+} spectrum_buffer_t;
+
+spectrum_plan_t *spectrumPlans[SPECTRUM_PLAN_CACHE];
+uint64_t spectrumPlanClock;
+pthread_mutex_t spectrumPlanLock = PTHREAD_MUTEX_INITIALIZER;
+
+/* aligned allocation that works without aligned_alloc (mingw), the original pointer is kept just before the aligned one */
+void *spectrum_aligned_alloc(size_t bytes) {
+    void *raw = malloc(bytes + SPECTRUM_ALIGN + sizeof(void *));
+    if (raw == NULL) {
+        return NULL;
+    }
+    uintptr_t aligned = ((uintptr_t) raw + sizeof(void *) + SPECTRUM_ALIGN - 1) & ~(uintptr_t) (SPECTRUM_ALIGN - 1);
+    ((void **) aligned)[-1] = raw;
+    return (void *) aligned;
+}
+
+void spectrum_aligned_free(void *pointer) {
+    if (pointer != NULL) {
+        free(((void **) pointer)[-1]);
+    }
+}
+
+void *spectrum_reserve(spectrum_buffer_t *buffer, size_t bytes) {
+    if (buffer -> size < bytes) {
+        spectrum_aligned_free(buffer -> data);
+        buffer -> data = spectrum_aligned_alloc(bytes);
+        buffer -> size = bytes;
+    }
+    return buffer -> data;
+}
+
+void spectrum_buffer_free(spectrum_buffer_t *buffer) {
+    spectrum_aligned_free(buffer -> data);
+    buffer -> data = NULL;
+    buffer -> size = 0;
+}
+
+spectrum_plan_t *spectrum_plan_init(int length) {
+    spectrum_plan_t *plan = malloc(sizeof(spectrum_plan_t));
+    int halfLength = length / 2;
+    plan -> length = length;
+    plan -> half = kiss_fft_alloc(halfLength, 0, NULL, NULL);
+    plan -> twiddles = spectrum_aligned_alloc(sizeof(kiss_fft_cpx) * (halfLength / 2 + 1));
+    for (int i = 0; i < halfLength / 2; i++) {
+        double phase = -M_PI * ((double) (i + 1) / halfLength + 0.5);
+        kf_cexp(plan -> twiddles + i, phase);
+    }
+    plan -> used = 0;
+    plan -> users = 0;
+    return plan;
+}
+
+void spectrum_plan_free(spectrum_plan_t *plan) {
+    kiss_fft_free(plan -> half);
+    spectrum_aligned_free(plan -> twiddles);
+    free(plan);
+}
+
+spectrum_plan_t *spectrum_plan(int length) {
+    pthread_mutex_lock(&spectrumPlanLock);
+    spectrum_plan_t *plan = NULL;
+    int slot = -1;
+    for (int i = 0; i < SPECTRUM_PLAN_CACHE; i++) {
+        if (spectrumPlans[i] != NULL && spectrumPlans[i] -> length == length) {
+            plan = spectrumPlans[i];
+            break;
+        }
+        /* empty slot, or else the least recently used one that is not in use */
+        if (spectrumPlans[i] == NULL || spectrumPlans[i] -> users == 0) {
+            if (slot == -1 || (spectrumPlans[slot] != NULL && (spectrumPlans[i] == NULL || spectrumPlans[i] -> used < spectrumPlans[slot] -> used))) {
+                slot = i;
+            }
+        }
+    }
+    if (plan == NULL) {
+        plan = spectrum_plan_init(length);
+        if (slot == -1) {
+            plan -> users = -SPECTRUM_PLAN_CACHE; // every slot is in use, this plan is not cached and is freed on release
+        } else {
+            if (spectrumPlans[slot] != NULL) {
+                spectrum_plan_free(spectrumPlans[slot]);
+            }
+            spectrumPlans[slot] = plan;
+        }
+    }
+    plan -> used = ++spectrumPlanClock;
+    plan -> users++;
+    pthread_mutex_unlock(&spectrumPlanLock);
+    return plan;
+}
+
+void spectrum_plan_release(spectrum_plan_t *plan) {
+    pthread_mutex_lock(&spectrumPlanLock);
+    plan -> users--;
+    if (plan -> users == -SPECTRUM_PLAN_CACHE) {
+        spectrum_plan_free(plan);
+    }
+    pthread_mutex_unlock(&spectrumPlanLock);
+}
+
+void spectrum_rfft(spectrum_plan_t *plan, const kiss_fft_scalar *samples, kiss_fft_cpx *bins, kiss_fft_cpx *work) {
+    int halfLength = plan -> length / 2;
+    /* even samples are the real parts and odd samples the imaginary parts of a half length complex signal */
+    kiss_fft(plan -> half, (const kiss_fft_cpx *) samples, work);
+    bins[0].r = work[0].r + work[0].i;
+    bins[halfLength].r = work[0].r - work[0].i;
+    bins[0].i = bins[0].r * 0;
+    bins[halfLength].i = bins[0].i;
+    for (int k = 1; k <= halfLength / 2; k++) {
+        kiss_fft_cpx even;
+        kiss_fft_cpx odd;
+        kiss_fft_cpx mirrored;
+        kiss_fft_cpx rotated;
+        mirrored.r = work[halfLength - k].r;
+        mirrored.i = -work[halfLength - k].i;
+        C_ADD(even, work[k], mirrored);
+        C_SUB(odd, work[k], mirrored);
+        C_MUL(rotated, odd, plan -> twiddles[k - 1]);
+        bins[k].r = HALF_OF(even.r + rotated.r);
+        bins[k].i = HALF_OF(even.i + rotated.i);
+        bins[halfLength - k].r = HALF_OF(even.r - rotated.r);
+        bins[halfLength - k].i = HALF_OF(rotated.i - even.i);
+    }
+}
+
+double spectrum_window(float *coefficients, int length, int type) {
+    double sum = 0;
+    int ramp = length * 0.1;
+    for (int i = 0; i < length; i++) {
+        double phase = 2 * M_PI * i / length; // periodic form, the next segment starts where this one would repeat
+        double value = 1;
+        if (type == SPECTRUM_WINDOW_HANN) {
+            value = 0.5 - 0.5 * cos(phase);
+        } else if (type == SPECTRUM_WINDOW_BLACKMAN_HARRIS) {
+            value = 0.35875 - 0.48829 * cos(phase) + 0.14128 * cos(2 * phase) - 0.01168 * cos(3 * phase);
+        } else if (type == SPECTRUM_WINDOW_FLAT_TOP) {
+            value = 0.21557895 - 0.41663158 * cos(phase) + 0.277263158 * cos(2 * phase) - 0.083578947 * cos(3 * phase) + 0.006947368 * cos(4 * phase);
+        } else if (i < ramp) {
+            value = (double) (i + 1) / ramp;
+        } else if (i >= length - ramp) {
+            value = (double) (length - i) / ramp;
+        }
+        coefficients[i] = value;
+        sum += value;
+    }
+    return sum;
+}
+
+void spectrum_load(kiss_fft_scalar *input, const float *const *signals, int lanes, const float *window, int windowLength, int length) {
+#ifdef USE_SIMD
+    const float *lane[SPECTRUM_LANES];
+    for (int j = 0; j < SPECTRUM_LANES; j++) {
+        lane[j] = j < lanes ? signals[j] : signals[0]; // unused lanes are zeroed by the mask
+    }
+    __m128 mask = _mm_cmplt_ps(_mm_set_ps(3, 2, 1, 0), _mm_set1_ps(lanes));
+    for (int i = 0; i < windowLength; i++) {
+        input[i] = _mm_and_ps(_mm_mul_ps(_mm_set_ps(lane[3][i], lane[2][i], lane[1][i], lane[0][i]), _mm_set1_ps(window[i])), mask);
+    }
+    for (int i = windowLength; i < length; i++) {
+        input[i] = _mm_setzero_ps();
+    }
+#else
+    (void) lanes;
+    const float *signal = signals[0];
+    for (int i = 0; i < windowLength; i++) {
+        input[i] = signal[i] * window[i];
+    }
+    for (int i = windowLength; i < length; i++) {
+        input[i] = 0;
+    }
+#endif
+}
+
+void spectrum_power(float *power, const kiss_fft_cpx *bins, int count) {
+    for (int i = 0; i < count; i++) {
+#ifdef USE_SIMD
+        _mm_store_ps(power + i * SPECTRUM_LANES, _mm_add_ps(_mm_mul_ps(bins[i].r, bins[i].r), _mm_mul_ps(bins[i].i, bins[i].i)));
+#else
+        power[i] = bins[i].r * bins[i].r + bins[i].i * bins[i].i;
+#endif
+    }
+}
+
+void spectrum_average(float *average, const float *power, int count, int lane, float weight) {
+    for (int i = 0; i < count; i++) {
+        average[i] += (power[i * SPECTRUM_LANES + lane] - average[i]) * weight;
+    }
+}
+
+void spectrum_magnitude(float *magnitude, const float *average, int count, int length, double windowSum) {
+    float scale = 2 / windowSum;
+    int i = 0;
+#ifdef USE_SIMD
+    __m128 scales = _mm_set1_ps(scale);
+    for (; i + SPECTRUM_LANES <= count; i += SPECTRUM_LANES) {
+        _mm_storeu_ps(magnitude + i, _mm_mul_ps(_mm_sqrt_ps(_mm_loadu_ps(average + i)), scales));
+    }
+#endif
+    for (; i < count; i++) {
+        magnitude[i] = sqrtf(average[i]) * scale;
+    }
+    /* DC and Nyquist have no mirrored negative frequency */
+    magnitude[0] /= 2;
+    if (length / 2 < count) {
+        magnitude[length / 2] /= 2;
+    }
+}
+
+float spectrum_lane(kiss_fft_scalar value, int lane) {
+#ifdef USE_SIMD
+    float lanes[SPECTRUM_LANES];
+    _mm_storeu_ps(lanes, value);
+    return lanes[lane];
+#else
+    (void) lane;
+    return value;
+#endif
+}
+
+void spectrum_cleanup() {
+    pthread_mutex_lock(&spectrumPlanLock);
+    for (int i = 0; i < SPECTRUM_PLAN_CACHE; i++) {
+        if (spectrumPlans[i] != NULL) {
+            spectrum_plan_free(spectrumPlans[i]);
+            spectrumPlans[i] = NULL;
+        }
+    }
+    pthread_mutex_unlock(&spectrumPlanLock);
+}
+
+#endif
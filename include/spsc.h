@@ -0,0 +1,111 @@
+/*
+lock-free single producer single consumer queue of timestamped samples
+
+one thread pushes, one (other) thread pops, neither ever waits on a lock
+the producer publishes a batch by storing head with release semantics, the consumer sees the whole batch once it loads head with acquire semantics
+
+create queue (capacity is rounded up to a power of two):
+spsc_t *queue = spsc_init([capacity]);
+
+push a batch of values (producer thread), returns how many fit - the rest are dropped and counted in queue -> dropped:
+spsc_push(queue, [values], [count]);
+
+pop up to maxCount values (consumer thread), returns how many were popped:
+spsc_pop(queue, [values], [maxCount]);
+
+number of values waiting (approximate when called from the producer):
+spsc_size(queue);
+
+free the queue (when neither thread is using it):
+spsc_free(queue);
+*/
+
+#ifndef SPSCSET
+#define SPSCSET 1 // include guard
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#define SPSC_CACHE_LINE 64
+
+typedef struct {
+    float value;
+    uint32_t timestamp; // raw AMDC packet timestamp
+} spsc_sample_t;
+
+typedef struct {
+    spsc_sample_t *data;
+    uint32_t capacity;
+    uint32_t mask;
+    uint64_t dropped; // values rejected because the queue was full (producer only)
+    char pad0[SPSC_CACHE_LINE]; // keep head and tail on separate cache lines
+    _Atomic uint32_t head; // next write position, only written by the producer
+    char pad1[SPSC_CACHE_LINE];
+    _Atomic uint32_t tail; // next read position, only written by the consumer
+} spsc_t;
+
+spsc_t *spsc_init(uint32_t capacity) {
+    uint32_t realCapacity = 1;
+    while (realCapacity < capacity) {
+        realCapacity <<= 1;
+    }
+    spsc_t *queue = malloc(sizeof(spsc_t));
+    queue -> data = malloc(realCapacity * sizeof(spsc_sample_t));
+    queue -> capacity = realCapacity;
+    queue -> mask = realCapacity - 1;
+    queue -> dropped = 0;
+    atomic_init(&queue -> head, 0);
+    atomic_init(&queue -> tail, 0);
+    return queue;
+}
+
+int spsc_push(spsc_t *queue, spsc_sample_t *values, int count) {
+    uint32_t head = atomic_load_explicit(&queue -> head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&queue -> tail, memory_order_acquire);
+    uint32_t space = queue -> capacity - (head - tail);
+    if ((uint32_t) count > space) {
+        queue -> dropped += count - space;
+        count = space;
+    }
+    /* copy in at most two pieces (before and after the wrap) */
+    uint32_t start = head & queue -> mask;
+    uint32_t firstPiece = queue -> capacity - start;
+    if (firstPiece > (uint32_t) count) {
+        firstPiece = count;
+    }
+    memcpy(queue -> data + start, values, firstPiece * sizeof(spsc_sample_t));
+    memcpy(queue -> data, values + firstPiece, (count - firstPiece) * sizeof(spsc_sample_t));
+    atomic_store_explicit(&queue -> head, head + count, memory_order_release);
+    return count;
+}
+
+int spsc_pop(spsc_t *queue, spsc_sample_t *values, int maxCount) {
+    uint32_t tail = atomic_load_explicit(&queue -> tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&queue -> head, memory_order_acquire);
+    uint32_t count = head - tail;
+    if (count > (uint32_t) maxCount) {
+        count = maxCount;
+    }
+    uint32_t start = tail & queue -> mask;
+    uint32_t firstPiece = queue -> capacity - start;
+    if (firstPiece > count) {
+        firstPiece = count;
+    }
+    memcpy(values, queue -> data + start, firstPiece * sizeof(spsc_sample_t));
+    memcpy(values + firstPiece, queue -> data, (count - firstPiece) * sizeof(spsc_sample_t));
+    atomic_store_explicit(&queue -> tail, tail + count, memory_order_release);
+    return count;
+}
+
+uint32_t spsc_size(spsc_t *queue) {
+    return atomic_load_explicit(&queue -> head, memory_order_acquire) - atomic_load_explicit(&queue -> tail, memory_order_acquire);
+}
+
+void spsc_free(spsc_t *queue) {
+    free(queue -> data);
+    free(queue);
+}
+
+#endif
@@ -0,0 +1,643 @@
+/*
+traceGL draws long line strips (oscilloscope and orbit traces) from a float vertex buffer with a small shader, instead of through the turtle pen
+vertices are (a, b) pairs, the shader maps them to the screen with a per-trace transform:
+x = offsetX + a * scaleX
+y = offsetY + b * scaleY
+(in turtle coordinates) so the caller hands over raw sample positions and values and never scales them on the CPU
+
+initialise once, after turtleInit:
+traceGLInit();
+
+every frame, before anything is drawn (after turtleClear):
+traceGLClear();
+
+draw a trace (queued into the turtle pipeline, so it is layered correctly with the windows around it):
+traceGLBegin([offsetX], [scaleX], [offsetY], [scaleY], [r], [g], [b], [width]);
+traceGLVertex([a], [b]);
+...
+traceGLEnd();
+
+draw straight from a channel that is mirrored on the GPU (see below), b is the sample value and a is the sample's absolute index minus firstIndex:
+traceGLMirrorDraw([mirror], [channel], [firstIndex], [endIndex], [offsetX], [scaleX], [offsetY], [scaleY], [r], [g], [b], [width]);
+returns 0 if the range is not mirrored (too long), the caller should then fall back to traceGLBegin/traceGLVertex/traceGLEnd
+
+a mirror keeps the newest TRACEGL_MIRROR_LENGTH samples of a channel in a GPU ring buffer
+only samples appended since the last draw are uploaded (glBufferSubData on the tail), scrolling only changes the transform uniform
+traceGLMirror *mirror = traceGLMirrorInit();
+traceGLMirrorFree(mirror);
+
+a pair mirrors two channels that share absolute indices (orbit X and Y) and draws them against each other, a is the X channel's sample and b the Y channel's:
+traceGLPair *pair = traceGLPairInit();
+traceGLPairDraw([pair], [channelX], [channelY], [firstIndex], [endIndex], [offsetX], [scaleX], [offsetY], [scaleY], [r], [g], [b], [width]);
+returns 0 if the range is not mirrored, like traceGLMirrorDraw
+traceGLPairFree(pair);
+
+an image is a scrolling heatmap (spectrogram) kept in a GPU texture ring, one texture row per image column so appending a column is one contiguous upload
+values are mapped through a 256 entry colormap between low and high when drawn, so changing the range or the colormap never re-uploads the image
+traceGLImage *image = traceGLImageInit([rows], [history]);
+traceGLImageColormap(image, [rgb]); // 256 * 3 bytes
+traceGLImageColumns(image, [values], [count]); // count columns of rows floats, appended after the newest
+traceGLImageDraw(image, [x1], [y1], [x2], [y2], [low], [high]); // newest column at the right edge, row 0 at the bottom
+traceGLImageClear(image); // every value back to TRACEGL_IMAGE_EMPTY
+traceGLImageFree(image);
+
+if the shader could not be built traceGLRender.enabled is 0 and the caller should draw with the turtle instead
+*/
+
+#ifndef TRACEGLSET
+#define TRACEGLSET 1 // include guard
+#include "turtle.h"
+#include "channel.h"
+
+#define TRACEGL_MAX_TRACES    64
+#define TRACEGL_MIRROR_LENGTH 65536 // samples mirrored per channel, a power of two
+#define TRACEGL_MAX_IMAGES    4
+#define TRACEGL_IMAGE_EMPTY   -1000.0 // value of image cells that have not been written, below any sensible low
+
+typedef struct {
+    GLuint vertexArray;
+    GLuint buffer; // ring of floats, slot = absolute index & (TRACEGL_MIRROR_LENGTH - 1)
+    channel_t *channel; // channel being mirrored
+    int64_t uploaded; // absolute index up to which the ring matches the channel
+} traceGLMirror;
+
+typedef struct {
+    GLuint vertexArray; // sample values of y as attribute 1 and of x as attribute 2
+    traceGLMirror *x;
+    traceGLMirror *y;
+} traceGLPair;
+
+typedef struct {
+    GLint first; // first vertex in this frame's buffer
+    GLsizei count;
+    GLfloat transform[4]; // offsetX, scaleX, offsetY, scaleY (normalised device coordinates)
+    GLfloat color[4];
+    GLfloat width; // line width in pixels
+    traceGLMirror *mirror; // NULL when the vertices are in this frame's buffer
+    traceGLPair *pair; // NULL unless drawn from two mirrors
+} traceGLTrace;
+
+typedef struct {
+    GLuint texture; // history rows of rows floats, row = column index % history
+    GLuint colormap; // 256 x 1 RGB
+    int rows; // values per column
+    int history; // columns kept
+    int64_t columns; // columns appended since the last clear
+} traceGLImage;
+
+typedef struct {
+    traceGLImage *image;
+    GLfloat rect[4]; // left, bottom, right, top (normalised device coordinates)
+    GLfloat mapping[3]; // low, high, texture coordinate of the oldest column
+} traceGLImageQuad;
+
+typedef struct { // traceGL variables
+    char enabled;
+    GLuint program;
+    GLint transformLocation;
+    GLint colorLocation;
+    GLint fromMirrorLocation;
+    GLuint vertexArray;
+    GLuint buffer;
+    GLsizeiptr bufferCapacity; // floats the GPU buffer can hold
+    float *vertices; // this frame's vertices, uploaded once on the first draw
+    int numVertices;
+    int vertexCapacity;
+    char uploaded; // whether this frame's vertices are on the GPU yet
+    traceGLTrace traces[TRACEGL_MAX_TRACES];
+    int numTraces;
+    GLuint imageProgram;
+    GLint imageRectLocation;
+    GLint imageMappingLocation;
+    GLint imageSamplerLocation;
+    GLint imageColormapLocation;
+    GLuint imageVertexArray; // the quad corners come from gl_VertexID, attribute 0 is only enabled for compatibility profile drivers (see traceGLInit)
+    GLuint imageBuffer;
+    traceGLImageQuad images[TRACEGL_MAX_IMAGES];
+    int numImages;
+    unsigned long long frame;
+} traceGL;
+
+traceGL traceGLRender;
+
+const char *traceGLVertexSource =
+    "#version 130\n"
+    "in vec2 vertex;\n"
+    "in float sampleValue;\n"
+    "in float pairValue;\n"
+    "uniform vec4 transform;\n"
+    "uniform int fromMirror;\n"
+    "void main() {\n"
+    "    vec2 point = vertex;\n"
+    "    if (fromMirror == 1) {\n"
+    "        point = vec2(float(gl_VertexID), sampleValue);\n"
+    "    } else if (fromMirror == 2) {\n"
+    "        point = vec2(pairValue, sampleValue);\n"
+    "    }\n"
+    "    gl_Position = vec4(transform.x + point.x * transform.y, transform.z + point.y * transform.w, 0.0, 1.0);\n"
+    "}\n";
+
+const char *traceGLFragmentSource =
+    "#version 130\n"
+    "uniform vec4 color;\n"
+    "out vec4 fragColor;\n"
+    "void main() {\n"
+    "    fragColor = color;\n"
+    "}\n";
+
+const char *traceGLImageVertexSource =
+    "#version 130\n"
+    "uniform vec4 rect;\n"
+    "out vec2 position;\n"
+    "void main() {\n"
+    "    position = vec2(float(gl_VertexID & 1), float(gl_VertexID >> 1));\n"
+    "    gl_Position = vec4(mix(rect.x, rect.z, position.x), mix(rect.y, rect.w, position.y), 0.0, 1.0);\n"
+    "}\n";
+
+/* x across the quad is time (texture rows, wrapping through the ring), y is the row within a column (texture x) */
+const char *traceGLImageFragmentSource =
+    "#version 130\n"
+    "uniform sampler2D image;\n"
+    "uniform sampler2D colormap;\n"
+    "uniform vec3 mapping;\n"
+    "in vec2 position;\n"
+    "out vec4 fragColor;\n"
+    "void main() {\n"
+    "    float value = texture(image, vec2(position.y, mapping.z + position.x)).r;\n"
+    "    float level = clamp((value - mapping.x) / (mapping.y - mapping.x), 0.0, 1.0);\n"
+    "    fragColor = vec4(texture(colormap, vec2(level, 0.5)).rgb, 1.0);\n"
+    "}\n";
+
+GLuint traceGLCompile(GLenum type, const char *source) {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, NULL);
+    glCompileShader(shader);
+    GLint status;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+    if (status == GL_FALSE) {
+        char log[512];
+        glGetShaderInfoLog(shader, sizeof(log), NULL, log);
+        printf("traceGL: shader failed to compile: %s\n", log);
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+int traceGLInit() { // returns 0 on success
+    traceGLRender.enabled = 0;
+    traceGLRender.numTraces = 0;
+    traceGLRender.numImages = 0;
+    traceGLRender.numVertices = 0;
+    traceGLRender.vertexCapacity = 4096;
+    traceGLRender.vertices = malloc(traceGLRender.vertexCapacity * 2 * sizeof(float));
+    traceGLRender.frame = 0;
+    if (glCreateShader == NULL || glGenVertexArrays == NULL) {
+        printf("traceGL: OpenGL 3 is not available, traces will be drawn with the turtle\n");
+        return -1;
+    }
+    GLuint vertexShader = traceGLCompile(GL_VERTEX_SHADER, traceGLVertexSource);
+    GLuint fragmentShader = traceGLCompile(GL_FRAGMENT_SHADER, traceGLFragmentSource);
+    if (vertexShader == 0 || fragmentShader == 0) {
+        return -1;
+    }
+    traceGLRender.program = glCreateProgram();
+    glAttachShader(traceGLRender.program, vertexShader);
+    glAttachShader(traceGLRender.program, fragmentShader);
+    glBindAttribLocation(traceGLRender.program, 0, "vertex");
+    glBindAttribLocation(traceGLRender.program, 1, "sampleValue");
+    glBindAttribLocation(traceGLRender.program, 2, "pairValue");
+    glLinkProgram(traceGLRender.program);
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+    GLint status;
+    glGetProgramiv(traceGLRender.program, GL_LINK_STATUS, &status);
+    if (status == GL_FALSE) {
+        printf("traceGL: shader failed to link\n");
+        return -1;
+    }
+    traceGLRender.transformLocation = glGetUniformLocation(traceGLRender.program, "transform");
+    traceGLRender.colorLocation = glGetUniformLocation(traceGLRender.program, "color");
+    traceGLRender.fromMirrorLocation = glGetUniformLocation(traceGLRender.program, "fromMirror");
+    vertexShader = traceGLCompile(GL_VERTEX_SHADER, traceGLImageVertexSource);
+    fragmentShader = traceGLCompile(GL_FRAGMENT_SHADER, traceGLImageFragmentSource);
+    if (vertexShader == 0 || fragmentShader == 0) {
+        return -1;
+    }
+    traceGLRender.imageProgram = glCreateProgram();
+    glAttachShader(traceGLRender.imageProgram, vertexShader);
+    glAttachShader(traceGLRender.imageProgram, fragmentShader);
+    glLinkProgram(traceGLRender.imageProgram);
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+    glGetProgramiv(traceGLRender.imageProgram, GL_LINK_STATUS, &status);
+    if (status == GL_FALSE) {
+        printf("traceGL: image shader failed to link\n");
+        return -1;
+    }
+    traceGLRender.imageRectLocation = glGetUniformLocation(traceGLRender.imageProgram, "rect");
+    traceGLRender.imageMappingLocation = glGetUniformLocation(traceGLRender.imageProgram, "mapping");
+    traceGLRender.imageSamplerLocation = glGetUniformLocation(traceGLRender.imageProgram, "image");
+    traceGLRender.imageColormapLocation = glGetUniformLocation(traceGLRender.imageProgram, "colormap");
+    /* compatibility profile contexts (the glfw default) may draw nothing unless attribute 0 is enabled, so every vertex array enables it even when the shader ignores it */
+    const float imageCorners[4] = {0, 1, 2, 3};
+    glGenVertexArrays(1, &traceGLRender.imageVertexArray);
+    glBindVertexArray(traceGLRender.imageVertexArray);
+    glGenBuffers(1, &traceGLRender.imageBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, traceGLRender.imageBuffer);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(imageCorners), imageCorners, GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 1, GL_FLOAT, GL_FALSE, sizeof(float), (void *) 0);
+    glGenVertexArrays(1, &traceGLRender.vertexArray);
+    glBindVertexArray(traceGLRender.vertexArray);
+    glGenBuffers(1, &traceGLRender.buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, traceGLRender.buffer);
+    traceGLRender.bufferCapacity = traceGLRender.vertexCapacity * 2;
+    glBufferData(GL_ARRAY_BUFFER, traceGLRender.bufferCapacity * sizeof(float), NULL, GL_STREAM_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void *) 0);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    traceGLRender.enabled = 1;
+    return 0;
+}
+
+void traceGLClear() {
+    traceGLRender.numTraces = 0;
+    traceGLRender.numImages = 0;
+    traceGLRender.numVertices = 0;
+    traceGLRender.uploaded = 0;
+    traceGLRender.frame++;
+}
+
+void traceGLDraw(int traceIndex) { // called from turtleUpdate
+    traceGLTrace *trace = &traceGLRender.traces[traceIndex];
+    if (trace -> count < 2) {
+        return;
+    }
+    glUseProgram(traceGLRender.program);
+    glUniform4fv(traceGLRender.transformLocation, 1, trace -> transform);
+    glUniform4fv(traceGLRender.colorLocation, 1, trace -> color);
+    glLineWidth(trace -> width);
+    if (trace -> pair != NULL) {
+        glUniform1i(traceGLRender.fromMirrorLocation, 2);
+        glBindVertexArray(trace -> pair -> vertexArray);
+        glDrawArrays(GL_LINE_STRIP, trace -> first, trace -> count);
+        glUseProgram(0);
+        glBindVertexArray(0);
+        return;
+    }
+    if (trace -> mirror != NULL) {
+        glUniform1i(traceGLRender.fromMirrorLocation, 1);
+        glBindVertexArray(trace -> mirror -> vertexArray);
+        glDrawArrays(GL_LINE_STRIP, trace -> first, trace -> count);
+        glUseProgram(0);
+        glBindVertexArray(0);
+        return;
+    }
+    glUniform1i(traceGLRender.fromMirrorLocation, 0);
+    glBindVertexArray(traceGLRender.vertexArray);
+    glBindBuffer(GL_ARRAY_BUFFER, traceGLRender.buffer);
+    if (!traceGLRender.uploaded) {
+        /* one upload for every trace this frame, the buffer is orphaned so the driver never waits on last frame's draws */
+        if (traceGLRender.numVertices * 2 > traceGLRender.bufferCapacity) {
+            traceGLRender.bufferCapacity = traceGLRender.vertexCapacity * 2;
+        }
+        glBufferData(GL_ARRAY_BUFFER, traceGLRender.bufferCapacity * sizeof(float), NULL, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, traceGLRender.numVertices * 2 * sizeof(float), traceGLRender.vertices);
+        traceGLRender.uploaded = 1;
+    }
+    glDrawArrays(GL_LINE_STRIP, trace -> first, trace -> count);
+    glUseProgram(0);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void traceGLBegin(double offsetX, double scaleX, double offsetY, double scaleY, double r, double g, double b, double width) {
+    if (traceGLRender.numTraces == TRACEGL_MAX_TRACES) {
+        return;
+    }
+    /* fold the turtle's world to screen scaling into the transform */
+    double xfact = 2.0 / (turtle.bounds[2] - turtle.bounds[0]);
+    double yfact = 2.0 / (turtle.bounds[3] - turtle.bounds[1]);
+    traceGLTrace *trace = &traceGLRender.traces[traceGLRender.numTraces];
+    trace -> mirror = NULL;
+    trace -> pair = NULL;
+    trace -> first = traceGLRender.numVertices;
+    trace -> count = 0;
+    trace -> transform[0] = offsetX * xfact;
+    trace -> transform[1] = scaleX * xfact;
+    trace -> transform[2] = offsetY * yfact;
+    trace -> transform[3] = scaleY * yfact;
+    trace -> color[0] = r / 255;
+    trace -> color[1] = g / 255;
+    trace -> color[2] = b / 255;
+    trace -> color[3] = 1.0;
+    trace -> width = width * turtle.screenbounds[0] / (turtle.bounds[2] - turtle.bounds[0]);
+    if (trace -> width < 1) {
+        trace -> width = 1;
+    }
+}
+
+void traceGLVertex(double a, double b) {
+    if (traceGLRender.numTraces == TRACEGL_MAX_TRACES) {
+        return;
+    }
+    if (traceGLRender.numVertices == traceGLRender.vertexCapacity) {
+        traceGLRender.vertexCapacity *= 2;
+        traceGLRender.vertices = realloc(traceGLRender.vertices, traceGLRender.vertexCapacity * 2 * sizeof(float));
+    }
+    traceGLRender.vertices[traceGLRender.numVertices * 2] = a;
+    traceGLRender.vertices[traceGLRender.numVertices * 2 + 1] = b;
+    traceGLRender.numVertices++;
+    traceGLRender.traces[traceGLRender.numTraces].count++;
+}
+
+void traceGLEnd() {
+    if (traceGLRender.numTraces == TRACEGL_MAX_TRACES) {
+        return;
+    }
+    turtleCustom(traceGLDraw, traceGLRender.numTraces, traceGLRender.frame);
+    traceGLRender.numTraces++;
+}
+
+traceGLMirror *traceGLMirrorInit() {
+    traceGLMirror *mirror = malloc(sizeof(traceGLMirror));
+    glGenVertexArrays(1, &mirror -> vertexArray);
+    glBindVertexArray(mirror -> vertexArray);
+    glGenBuffers(1, &mirror -> buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, mirror -> buffer);
+    glBufferData(GL_ARRAY_BUFFER, TRACEGL_MIRROR_LENGTH * sizeof(float), NULL, GL_DYNAMIC_DRAW);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, sizeof(float), (void *) 0);
+    glEnableVertexAttribArray(0); // unused by the mirror path, enabled for compatibility profiles (see traceGLInit)
+    glVertexAttribPointer(0, 1, GL_FLOAT, GL_FALSE, sizeof(float), (void *) 0);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    mirror -> channel = NULL;
+    mirror -> uploaded = 0;
+    return mirror;
+}
+
+void traceGLMirrorFree(traceGLMirror *mirror) {
+    glDeleteBuffers(1, &mirror -> buffer);
+    glDeleteVertexArrays(1, &mirror -> vertexArray);
+    free(mirror);
+}
+
+/* upload [start, end) of the channel into the ring, in at most two pieces */
+void traceGLMirrorUpload(traceGLMirror *mirror, int64_t start, int64_t end) {
+    float upload[4096];
+    int64_t index = start;
+    while (index < end) {
+        int64_t slot = index & (TRACEGL_MIRROR_LENGTH - 1);
+        int64_t count = end - index;
+        if (count > TRACEGL_MIRROR_LENGTH - slot) {
+            count = TRACEGL_MIRROR_LENGTH - slot; // stop at the wrap
+        }
+        if (count > 4096) {
+            count = 4096;
+        }
+        for (int64_t i = 0; i < count; i++) {
+            upload[i] = channel_get(mirror -> channel, index + i);
+        }
+        glBufferSubData(GL_ARRAY_BUFFER, slot * sizeof(float), count * sizeof(float), upload);
+        index += count;
+    }
+}
+
+/* bring the mirror up to date with the channel, only the samples appended since last time are uploaded */
+void traceGLMirrorSync(traceGLMirror *mirror, channel_t *channel) {
+    if (mirror -> channel != channel || mirror -> uploaded > channel -> length) {
+        mirror -> channel = channel;
+        mirror -> uploaded = 0;
+    }
+    int64_t start = mirror -> uploaded;
+    if (start < channel -> length - TRACEGL_MIRROR_LENGTH) {
+        start = channel -> length - TRACEGL_MIRROR_LENGTH;
+    }
+    if (start < channel_start(channel)) {
+        start = channel_start(channel);
+    }
+    if (start < channel -> length) {
+        glBindBuffer(GL_ARRAY_BUFFER, mirror -> buffer);
+        traceGLMirrorUpload(mirror, start, channel -> length);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+    mirror -> uploaded = channel -> length;
+}
+
+int traceGLMirrorDraw(traceGLMirror *mirror, channel_t *channel, int64_t firstIndex, int64_t endIndex, double offsetX, double scaleX, double offsetY, double scaleY, double r, double g, double b, double width) {
+    if (endIndex - firstIndex > TRACEGL_MIRROR_LENGTH || firstIndex < channel -> length - TRACEGL_MIRROR_LENGTH || firstIndex < channel_start(channel)) {
+        return 0;
+    }
+    traceGLMirrorSync(mirror, channel);
+    if (endIndex - firstIndex < 2) {
+        return 1;
+    }
+    /* the range is one strip, or two when it crosses the end of the ring (joined by a two point strip from this frame's buffer) */
+    int64_t firstSlot = firstIndex & (TRACEGL_MIRROR_LENGTH - 1);
+    int64_t firstCount = endIndex - firstIndex;
+    if (firstCount > TRACEGL_MIRROR_LENGTH - firstSlot) {
+        firstCount = TRACEGL_MIRROR_LENGTH - firstSlot;
+    }
+    int64_t pieceStart[2] = {firstIndex, firstIndex + firstCount};
+    int64_t pieceCount[2] = {firstCount, endIndex - firstIndex - firstCount};
+    for (int piece = 0; piece < 2; piece++) {
+        if (pieceCount[piece] <= 0 || traceGLRender.numTraces == TRACEGL_MAX_TRACES) {
+            continue;
+        }
+        int64_t slot = pieceStart[piece] & (TRACEGL_MIRROR_LENGTH - 1);
+        /* gl_VertexID is the slot, so shift x by where that slot sits relative to firstIndex */
+        traceGLBegin(offsetX + (double) (pieceStart[piece] - firstIndex - slot) * scaleX, scaleX, offsetY, scaleY, r, g, b, width);
+        traceGLTrace *trace = &traceGLRender.traces[traceGLRender.numTraces];
+        trace -> mirror = mirror;
+        trace -> first = slot;
+        trace -> count = pieceCount[piece];
+        traceGLEnd();
+    }
+    if (pieceCount[1] > 0) {
+        traceGLBegin(offsetX, scaleX, offsetY, scaleY, r, g, b, width);
+        traceGLVertex(pieceStart[1] - 1 - firstIndex, channel_get(channel, pieceStart[1] - 1));
+        traceGLVertex(pieceStart[1] - firstIndex, channel_get(channel, pieceStart[1]));
+        traceGLEnd();
+    }
+    return 1;
+}
+
+traceGLPair *traceGLPairInit() {
+    traceGLPair *pair = malloc(sizeof(traceGLPair));
+    pair -> x = traceGLMirrorInit();
+    pair -> y = traceGLMirrorInit();
+    glGenVertexArrays(1, &pair -> vertexArray);
+    glBindVertexArray(pair -> vertexArray);
+    glBindBuffer(GL_ARRAY_BUFFER, pair -> y -> buffer);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, sizeof(float), (void *) 0);
+    glBindBuffer(GL_ARRAY_BUFFER, pair -> x -> buffer);
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, sizeof(float), (void *) 0);
+    glEnableVertexAttribArray(0); // unused by the pair path, enabled for compatibility profiles (see traceGLInit)
+    glVertexAttribPointer(0, 1, GL_FLOAT, GL_FALSE, sizeof(float), (void *) 0);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return pair;
+}
+
+void traceGLPairFree(traceGLPair *pair) {
+    glDeleteVertexArrays(1, &pair -> vertexArray);
+    traceGLMirrorFree(pair -> x);
+    traceGLMirrorFree(pair -> y);
+    free(pair);
+}
+
+int traceGLPairDraw(traceGLPair *pair, channel_t *channelX, channel_t *channelY, int64_t firstIndex, int64_t endIndex, double offsetX, double scaleX, double offsetY, double scaleY, double r, double g, double b, double width) {
+    for (int i = 0; i < 2; i++) {
+        channel_t *channel = i == 0 ? channelX : channelY;
+        if (endIndex - firstIndex > TRACEGL_MIRROR_LENGTH || firstIndex < channel -> length - TRACEGL_MIRROR_LENGTH || firstIndex < channel_start(channel)) {
+            return 0;
+        }
+    }
+    traceGLMirrorSync(pair -> x, channelX);
+    traceGLMirrorSync(pair -> y, channelY);
+    if (endIndex - firstIndex < 2) {
+        return 1;
+    }
+    /* one strip, or two when the range crosses the end of the ring (joined by a two point strip from this frame's buffer) */
+    int64_t firstSlot = firstIndex & (TRACEGL_MIRROR_LENGTH - 1);
+    int64_t firstCount = endIndex - firstIndex;
+    if (firstCount > TRACEGL_MIRROR_LENGTH - firstSlot) {
+        firstCount = TRACEGL_MIRROR_LENGTH - firstSlot;
+    }
+    int64_t pieceStart[2] = {firstIndex, firstIndex + firstCount};
+    int64_t pieceCount[2] = {firstCount, endIndex - firstIndex - firstCount};
+    for (int piece = 0; piece < 2; piece++) {
+        if (pieceCount[piece] <= 0 || traceGLRender.numTraces == TRACEGL_MAX_TRACES) {
+            continue;
+        }
+        traceGLBegin(offsetX, scaleX, offsetY, scaleY, r, g, b, width);
+        traceGLTrace *trace = &traceGLRender.traces[traceGLRender.numTraces];
+        trace -> pair = pair;
+        trace -> first = pieceStart[piece] & (TRACEGL_MIRROR_LENGTH - 1);
+        trace -> count = pieceCount[piece];
+        traceGLEnd();
+    }
+    if (pieceCount[1] > 0) {
+        traceGLBegin(offsetX, scaleX, offsetY, scaleY, r, g, b, width);
+        traceGLVertex(channel_get(channelX, pieceStart[1] - 1), channel_get(channelY, pieceStart[1] - 1));
+        traceGLVertex(channel_get(channelX, pieceStart[1]), channel_get(channelY, pieceStart[1]));
+        traceGLEnd();
+    }
+    return 1;
+}
+
+void traceGLImageClear(traceGLImage *image) {
+    float *empty = malloc(sizeof(float) * image -> rows * image -> history);
+    for (int i = 0; i < image -> rows * image -> history; i++) {
+        empty[i] = TRACEGL_IMAGE_EMPTY;
+    }
+    glBindTexture(GL_TEXTURE_2D, image -> texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, image -> rows, image -> history, 0, GL_RED, GL_FLOAT, empty);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    free(empty);
+    image -> columns = 0;
+}
+
+traceGLImage *traceGLImageInit(int rows, int history) {
+    traceGLImage *image = malloc(sizeof(traceGLImage));
+    image -> rows = rows;
+    image -> history = history;
+    glGenTextures(1, &image -> texture);
+    glBindTexture(GL_TEXTURE_2D, image -> texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT); // time wraps through the ring
+    glGenTextures(1, &image -> colormap);
+    glBindTexture(GL_TEXTURE_2D, image -> colormap);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    traceGLImageClear(image);
+    return image;
+}
+
+void traceGLImageFree(traceGLImage *image) {
+    glDeleteTextures(1, &image -> texture);
+    glDeleteTextures(1, &image -> colormap);
+    free(image);
+}
+
+void traceGLImageColormap(traceGLImage *image, const unsigned char *rgb) {
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glBindTexture(GL_TEXTURE_2D, image -> colormap);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, 256, 1, 0, GL_RGB, GL_UNSIGNED_BYTE, rgb);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+/* append count columns of rows floats each, in at most two uploads (split where the ring wraps) */
+void traceGLImageColumns(traceGLImage *image, const float *values, int count) {
+    if (count > image -> history) {
+        values += (int64_t) (count - image -> history) * image -> rows; // older columns would be overwritten straight away
+        image -> columns += count - image -> history;
+        count = image -> history;
+    }
+    glBindTexture(GL_TEXTURE_2D, image -> texture);
+    while (count > 0) {
+        int slot = image -> columns % image -> history;
+        int piece = count;
+        if (piece > image -> history - slot) {
+            piece = image -> history - slot;
+        }
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, slot, image -> rows, piece, GL_RED, GL_FLOAT, values);
+        values += (int64_t) piece * image -> rows;
+        image -> columns += piece;
+        count -= piece;
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void traceGLDrawImage(int imageIndex) { // called from turtleUpdate
+    traceGLImageQuad *quad = &traceGLRender.images[imageIndex];
+    glUseProgram(traceGLRender.imageProgram);
+    glUniform4fv(traceGLRender.imageRectLocation, 1, quad -> rect);
+    glUniform3fv(traceGLRender.imageMappingLocation, 1, quad -> mapping);
+    glUniform1i(traceGLRender.imageSamplerLocation, 0);
+    glUniform1i(traceGLRender.imageColormapLocation, 1);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, quad -> image -> colormap);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, quad -> image -> texture);
+    glBindVertexArray(traceGLRender.imageVertexArray);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE0);
+    glUseProgram(0);
+}
+
+void traceGLImageDraw(traceGLImage *image, double x1, double y1, double x2, double y2, double low, double high) {
+    if (traceGLRender.numImages == TRACEGL_MAX_IMAGES) {
+        return;
+    }
+    double xfact = 2.0 / (turtle.bounds[2] - turtle.bounds[0]);
+    double yfact = 2.0 / (turtle.bounds[3] - turtle.bounds[1]);
+    traceGLImageQuad *quad = &traceGLRender.images[traceGLRender.numImages];
+    quad -> image = image;
+    quad -> rect[0] = x1 * xfact;
+    quad -> rect[1] = y1 * yfact;
+    quad -> rect[2] = x2 * xfact;
+    quad -> rect[3] = y2 * yfact;
+    quad -> mapping[0] = low;
+    quad -> mapping[1] = high;
+    quad -> mapping[2] = (double) (image -> columns % image -> history) / image -> history;
+    turtleCustom(traceGLDrawImage, traceGLRender.numImages, traceGLRender.frame);
+    traceGLRender.numImages++;
+}
+
+#endif
@@ -0,0 +1,377 @@
+/*
+trigger engine - finds trigger events in a channel, looking at every sample appended since the last scan
+
+the scan classifies a block of samples against the trigger levels in a few vector compares (SSE/AVX when compiled for them, plain C otherwise)
+and only runs the trigger's state machine on the samples where that classification changes, so it keeps up with the full sample rate whether or not the signal is busy
+
+a condition says what to look for:
+trigger_condition_t condition;
+condition.type = [TRIGGER_RISING_EDGE, ...]; // see enum trigger_type
+condition.level[0] = [threshold]; // edges and pulses only use level[0]
+condition.level[1] = [second level]; // window, runt and slope use the band between level[0] and level[1] (either order)
+condition.width[0] = [minimum samples]; // pulse width and slope time limits
+condition.width[1] = [maximum samples]; // 0 for no upper limit
+
+create an engine that starts scanning after the newest sample of the channel:
+trigger_t trigger;
+trigger_init(&trigger, [channel]);
+
+scan every sample appended since the last call, returns how many events were queued:
+trigger_scan(&trigger, [channel], &condition);
+
+an event is queued as the first sample past the level that completed it and how far between the sample before it and that sample the level was met (linear interpolation)
+so the exact trigger point is at fractional absolute index event.index - 1 + event.fraction
+
+pop the oldest queued event, returns 0 if there are none:
+trigger_event_t event;
+trigger_pop(&trigger, &event);
+
+number of queued events:
+trigger_size(&trigger);
+
+whether a single value satisfies a condition used as a qualifier (rising types: at or above their level, falling types: below it, window in/out: inside/outside the band):
+trigger_qualify(&condition, [value]);
+
+only the newest TRIGGER_QUEUE_LENGTH events are kept, older ones are dropped and counted in trigger.dropped
+*/
+
+#ifndef TRIGGERSET
+#define TRIGGERSET 1 // include guard
+
+#include <stdint.h>
+#include "channel.h"
+#if (defined(__SSE__) || defined(__AVX__)) && !defined(CHANNEL_DOUBLE)
+#include <immintrin.h>
+#endif
+
+#define TRIGGER_QUEUE_LENGTH 256 // power of two
+#define TRIGGER_BLOCK 32 // samples classified per mask word
+
+enum trigger_type {
+    TRIGGER_NONE = 0,
+    TRIGGER_RISING_EDGE,
+    TRIGGER_FALLING_EDGE,
+    TRIGGER_PULSE_POSITIVE, // high pulse whose width is within limits, fires on its falling edge
+    TRIGGER_PULSE_NEGATIVE, // low pulse whose width is within limits, fires on its rising edge
+    TRIGGER_WINDOW_ENTER, // enters the band
+    TRIGGER_WINDOW_EXIT, // leaves the band
+    TRIGGER_RUNT_POSITIVE, // rises into the band and falls back out of the bottom without reaching the top
+    TRIGGER_RUNT_NEGATIVE, // falls into the band and rises back out of the top without reaching the bottom
+    TRIGGER_SLOPE_RISING, // crosses the band bottom to top in a time within limits
+    TRIGGER_SLOPE_FALLING // crosses the band top to bottom in a time within limits
+};
+
+typedef struct {
+    int type;
+    double level[2];
+    double width[2]; // [min, max] in samples, max <= 0 for no upper limit
+} trigger_condition_t;
+
+typedef struct {
+    int64_t index; // absolute index of the first sample past the level
+    double fraction; // 0 to 1, where between sample index - 1 and sample index the level was met
+} trigger_event_t;
+
+typedef struct {
+    int64_t scanned; // absolute index of the next sample to scan
+    sample_t previous; // last sample scanned
+    int type; // condition type the state below belongs to
+    int marked; // a pulse, runt or slope has started
+    double mark; // fractional absolute index where it started
+    int reached; // a runt has reached the far side of the band
+    trigger_event_t events[TRIGGER_QUEUE_LENGTH];
+    uint32_t head; // next event written
+    uint32_t tail; // next event read
+    uint64_t dropped; // events overwritten before they were popped
+} trigger_t;
+
+void trigger_init(trigger_t *trigger, channel_t *channel) {
+    trigger -> scanned = channel -> length;
+    trigger -> previous = channel -> length > 0 ? channel_get(channel, channel -> length - 1) : 0;
+    trigger -> type = TRIGGER_NONE;
+    trigger -> marked = 0;
+    trigger -> mark = 0;
+    trigger -> reached = 0;
+    trigger -> head = 0;
+    trigger -> tail = 0;
+    trigger -> dropped = 0;
+}
+
+void trigger_push(trigger_t *trigger, int64_t index, double fraction) {
+    if (trigger -> head - trigger -> tail == TRIGGER_QUEUE_LENGTH) {
+        trigger -> tail++;
+        trigger -> dropped++;
+    }
+    trigger -> events[trigger -> head & (TRIGGER_QUEUE_LENGTH - 1)].index = index;
+    trigger -> events[trigger -> head & (TRIGGER_QUEUE_LENGTH - 1)].fraction = fraction;
+    trigger -> head++;
+}
+
+int trigger_pop(trigger_t *trigger, trigger_event_t *event) {
+    if (trigger -> head == trigger -> tail) {
+        return 0;
+    }
+    *event = trigger -> events[trigger -> tail & (TRIGGER_QUEUE_LENGTH - 1)];
+    trigger -> tail++;
+    return 1;
+}
+
+uint32_t trigger_size(trigger_t *trigger) {
+    return trigger -> head - trigger -> tail;
+}
+
+/* whether the condition uses the band between two levels */
+int trigger_banded(int type) {
+    return type >= TRIGGER_WINDOW_ENTER;
+}
+
+int trigger_qualify(trigger_condition_t *condition, double value) {
+    double low = condition -> level[0];
+    double high = condition -> level[1];
+    if (low > high) {
+        low = condition -> level[1];
+        high = condition -> level[0];
+    }
+    switch (condition -> type) {
+        case TRIGGER_RISING_EDGE:
+        case TRIGGER_PULSE_POSITIVE:
+        return value >= condition -> level[0];
+        case TRIGGER_FALLING_EDGE:
+        case TRIGGER_PULSE_NEGATIVE:
+        return value < condition -> level[0];
+        case TRIGGER_WINDOW_ENTER:
+        return value >= low && value < high;
+        case TRIGGER_WINDOW_EXIT:
+        return !(value >= low && value < high);
+        case TRIGGER_RUNT_POSITIVE:
+        case TRIGGER_SLOPE_RISING:
+        return value >= low;
+        case TRIGGER_RUNT_NEGATIVE:
+        case TRIGGER_SLOPE_FALLING:
+        return value < high;
+        default:
+        return 1;
+    }
+}
+
+/* bit i of the result is set if samples[i] >= level (count is at most TRIGGER_BLOCK), NaN counts as below */
+uint32_t trigger_above_mask(const sample_t *samples, int count, sample_t level) {
+    uint32_t mask = 0;
+    int i = 0;
+#if defined(__AVX__) && !defined(CHANNEL_DOUBLE)
+    __m256 wideLevel = _mm256_set1_ps(level);
+    for (; i + 8 <= count; i += 8) {
+        mask |= (uint32_t) _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(samples + i), wideLevel, _CMP_GE_OQ)) << i;
+    }
+#elif defined(__SSE__) && !defined(CHANNEL_DOUBLE)
+    __m128 wideLevel = _mm_set1_ps(level);
+    for (; i + 4 <= count; i += 4) {
+        mask |= (uint32_t) _mm_movemask_ps(_mm_cmpge_ps(_mm_loadu_ps(samples + i), wideLevel)) << i;
+    }
+#endif
+    for (; i < count; i++) {
+        mask |= (uint32_t) (samples[i] >= level) << i;
+    }
+    return mask;
+}
+
+/* where between before and after the line between them meets level (0 to 1) */
+double trigger_fraction(double before, double after, double level) {
+    double fraction = (level - before) / (after - before);
+    if (!(fraction >= 0)) { // also catches NaN
+        return 0;
+    }
+    if (fraction > 1) {
+        return 1;
+    }
+    return fraction;
+}
+
+int trigger_within(trigger_condition_t *condition, double width) {
+    return width >= condition -> width[0] && (condition -> width[1] <= 0 || width <= condition -> width[1]);
+}
+
+/* advance the state machine over one sample whose classification changed
+lowBefore/lowAfter is whether the samples either side are at or above the low level (the only level for edges and pulses), highBefore/highAfter the same for the high level */
+int trigger_step(trigger_t *trigger, trigger_condition_t *condition, int64_t index, double before, double after, double low, double high, int lowBefore, int lowAfter, int highBefore, int highAfter) {
+    double lowCrossing = index - 1 + trigger_fraction(before, after, low);
+    double highCrossing = index - 1 + trigger_fraction(before, after, high);
+    int found = 0;
+    switch (condition -> type) {
+        case TRIGGER_RISING_EDGE:
+        if (!lowBefore && lowAfter) {
+            trigger_push(trigger, index, lowCrossing - (index - 1));
+            found = 1;
+        }
+        break;
+        case TRIGGER_FALLING_EDGE:
+        if (lowBefore && !lowAfter) {
+            trigger_push(trigger, index, lowCrossing - (index - 1));
+            found = 1;
+        }
+        break;
+        case TRIGGER_PULSE_POSITIVE:
+        case TRIGGER_PULSE_NEGATIVE:
+        /* a pulse starts on one edge and is measured on the next */
+        if (lowBefore != lowAfter) {
+            int starts = condition -> type == TRIGGER_PULSE_POSITIVE ? lowAfter : !lowAfter;
+            if (starts) {
+                trigger -> marked = 1;
+                trigger -> mark = lowCrossing;
+            } else {
+                if (trigger -> marked && trigger_within(condition, lowCrossing - trigger -> mark)) {
+                    trigger_push(trigger, index, lowCrossing - (index - 1));
+                    found = 1;
+                }
+                trigger -> marked = 0;
+            }
+        }
+        break;
+        case TRIGGER_WINDOW_ENTER:
+        case TRIGGER_WINDOW_EXIT: {
+            int insideBefore = lowBefore && !highBefore;
+            int insideAfter = lowAfter && !highAfter;
+            if (insideBefore != insideAfter && insideAfter == (condition -> type == TRIGGER_WINDOW_ENTER)) {
+                /* the level crossed is the one whose classification changed */
+                double crossing = lowBefore != lowAfter ? lowCrossing : highCrossing;
+                trigger_push(trigger, index, crossing - (index - 1));
+                found = 1;
+            }
+            break;
+        }
+        case TRIGGER_RUNT_POSITIVE:
+        if (!lowBefore && lowAfter) {
+            trigger -> marked = 1;
+            trigger -> reached = 0;
+        }
+        if (highAfter) {
+            trigger -> reached = 1;
+        }
+        if (lowBefore && !lowAfter) {
+            if (trigger -> marked && !trigger -> reached) {
+                trigger_push(trigger, index, lowCrossing - (index - 1));
+                found = 1;
+            }
+            trigger -> marked = 0;
+        }
+        break;
+        case TRIGGER_RUNT_NEGATIVE:
+        if (highBefore && !highAfter) {
+            trigger -> marked = 1;
+            trigger -> reached = 0;
+        }
+        if (!lowAfter) {
+            trigger -> reached = 1;
+        }
+        if (!highBefore && highAfter) {
+            if (trigger -> marked && !trigger -> reached) {
+                trigger_push(trigger, index, highCrossing - (index - 1));
+                found = 1;
+            }
+            trigger -> marked = 0;
+        }
+        break;
+        case TRIGGER_SLOPE_RISING:
+        /* timed from leaving the bottom of the band to reaching the top */
+        if (lowBefore != lowAfter) {
+            trigger -> marked = lowAfter;
+            trigger -> mark = lowCrossing;
+        }
+        if (!highBefore && highAfter) {
+            if (trigger -> marked && trigger_within(condition, highCrossing - trigger -> mark)) {
+                trigger_push(trigger, index, highCrossing - (index - 1));
+                found = 1;
+            }
+            trigger -> marked = 0;
+        }
+        break;
+        case TRIGGER_SLOPE_FALLING:
+        if (highBefore != highAfter) {
+            trigger -> marked = !highAfter;
+            trigger -> mark = highCrossing;
+        }
+        if (lowBefore && !lowAfter) {
+            if (trigger -> marked && trigger_within(condition, lowCrossing - trigger -> mark)) {
+                trigger_push(trigger, index, lowCrossing - (index - 1));
+                found = 1;
+            }
+            trigger -> marked = 0;
+        }
+        break;
+        default:
+        break;
+    }
+    return found;
+}
+
+/* run the condition over count contiguous samples starting at absolute index first, previous is the sample before them */
+int trigger_run(trigger_t *trigger, trigger_condition_t *condition, const sample_t *samples, int count, int64_t first, sample_t previous) {
+    int found = 0;
+    double low = condition -> level[0];
+    double high = condition -> level[1];
+    int banded = trigger_banded(condition -> type);
+    if (banded && low > high) {
+        low = condition -> level[1];
+        high = condition -> level[0];
+    }
+    uint32_t previousLow = previous >= (sample_t) low;
+    uint32_t previousHigh = banded && previous >= (sample_t) high;
+    for (int block = 0; block < count; block += TRIGGER_BLOCK) {
+        int blockCount = count - block < TRIGGER_BLOCK ? count - block : TRIGGER_BLOCK;
+        uint32_t lowMask = trigger_above_mask(samples + block, blockCount, low);
+        uint32_t highMask = banded ? trigger_above_mask(samples + block, blockCount, high) : 0;
+        /* bit i of the shifted masks is the classification of the sample before sample i */
+        uint32_t lowShifted = (lowMask << 1) | previousLow;
+        uint32_t highShifted = (highMask << 1) | previousHigh;
+        uint32_t changes = (lowMask ^ lowShifted) | (highMask ^ highShifted);
+        if (blockCount < TRIGGER_BLOCK) {
+            changes &= ((uint32_t) 1 << blockCount) - 1;
+        }
+        previousLow = (lowMask >> (blockCount - 1)) & 1;
+        previousHigh = (highMask >> (blockCount - 1)) & 1;
+        while (changes) {
+            int bit = __builtin_ctz(changes);
+            changes &= changes - 1;
+            int i = block + bit;
+            double before = i > 0 ? samples[i - 1] : previous;
+            found += trigger_step(trigger, condition, first + i, before, samples[i], low, high, (lowShifted >> bit) & 1, (lowMask >> bit) & 1, (highShifted >> bit) & 1, (highMask >> bit) & 1);
+        }
+    }
+    return found;
+}
+
+int trigger_scan(trigger_t *trigger, channel_t *channel, trigger_condition_t *condition) {
+    if (trigger -> type != condition -> type) {
+        /* a half measured pulse, runt or slope means nothing to a different condition */
+        trigger -> type = condition -> type;
+        trigger -> marked = 0;
+        trigger -> reached = 0;
+    }
+    if (trigger -> scanned >= channel -> length) {
+        return 0;
+    }
+    /* samples overwritten before they were scanned are skipped */
+    if (trigger -> scanned < channel_start(channel)) {
+        trigger -> scanned = channel_start(channel);
+        trigger -> previous = channel_get(channel, trigger -> scanned);
+        trigger -> scanned++;
+        trigger -> marked = 0;
+    }
+    int found = 0;
+    while (trigger -> scanned < channel -> length) {
+        /* the ring is contiguous up to its wrap point */
+        int64_t offset = trigger -> scanned & channel -> mask;
+        int64_t count = channel -> length - trigger -> scanned;
+        if (count > channel -> capacity - offset) {
+            count = channel -> capacity - offset;
+        }
+        if (condition -> type != TRIGGER_NONE) {
+            found += trigger_run(trigger, condition, channel -> data + offset, count, trigger -> scanned, trigger -> previous);
+        }
+        trigger -> previous = channel -> data[offset + count - 1];
+        trigger -> scanned += count;
+    }
+    return found;
+}
+
+#endif
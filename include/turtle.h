@@ -478,6 +478,18 @@ void turtleRectangle(double x1, double y1, double x2, double y2, double r, doubl
     list_append(turtle.penPos, (unitype) 67, 'h'); // blit quad signifier
     list_append(turtle.penPos, (unitype) y2, 'd');
 }
+// adds a custom draw call to the pipeline, draw(argument) is called by turtleUpdate in order with everything else (frame should change every frame so the screen is redrawn)
+void turtleCustom(void (*draw)(int), int argument, unsigned long long frame) {
+    list_append(turtle.penPos, (unitype) (void *) draw, 'p');
+    list_append(turtle.penPos, (unitype) argument, 'i');
+    list_append(turtle.penPos, (unitype) (long long) frame, 'l');
+    list_append(turtle.penPos, (unitype) 0, 'd'); // zero'd out (wasted space)
+    list_append(turtle.penPos, (unitype) 0, 'd');
+    list_append(turtle.penPos, (unitype) 0, 'd');
+    list_append(turtle.penPos, (unitype) 0, 'd');
+    list_append(turtle.penPos, (unitype) 68, 'h'); // custom draw signifier
+    list_append(turtle.penPos, (unitype) 0, 'd');
+}
 // draws the turtle's path on the screen
 void turtleUpdate() {
     // used to have a feature that only redrew the screen if there have been any changes from last frame, but it has been removed.
@@ -506,6 +518,10 @@ void turtleUpdate() {
         double precomputedLog = 5;
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
         for (int i = 0; i < len; i += 9) {
+            if (renType[i] == 'p' && ren[i + 7].h == 68) { // custom draw
+                ((void (*)(int)) ren[i].p)(ren[i + 1].i);
+                continue;
+            }
             if (renType[i] == 'd') {
                 switch (ren[i + 7].h) {
                     case 0:
@@ -7,6 +7,310 @@ https://learn.microsoft.com/en-us/windows/win32/winsock/complete-client-code
 #ifndef WIN32TCP
 #define WIN32TCP 1 // include guard
 
+#ifdef OS_LINUX
+/*
+POSIX version of win32tcp, same function names so empv.c doesn't care which one it gets
+Sockets are connected as blocking sockets and then switched to non-blocking
+Logging sockets are registered with an epoll instance (win32tcpWatchSocket) so one thread can wait on all of them at once (win32tcpPoll)
+*/
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <netdb.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define WIN32TCP_NUM_SOCKETS 32
+#define WIN32TCP_TIMEOUT     1000 // milliseconds to wait for a non-blocking socket to become ready
+
+typedef int SOCKET;
+#define INVALID_SOCKET -1
+#define SOCKET_ERROR   -1
+#define SD_SEND        SHUT_WR
+#define closesocket    close // closing a file descriptor also removes it from the epoll set
+
+typedef struct {
+    char *address;
+    char *port;
+    SOCKET connectSocket[WIN32TCP_NUM_SOCKETS];
+    char socketOpen[WIN32TCP_NUM_SOCKETS];
+    int epollfd; // epoll instance holding every watched (logging) socket
+} win32SocketObject;
+
+win32SocketObject win32Socket;
+
+int win32tcpInit(char *address, char *port) {
+    for (int i = 0; i < WIN32TCP_NUM_SOCKETS; i++) {
+        win32Socket.connectSocket[i] = INVALID_SOCKET;
+        win32Socket.socketOpen[i] = 0;
+    }
+    win32Socket.address = address;
+    win32Socket.port = port;
+    char modifiable[strlen(address) + 1];
+    strcpy(modifiable, address);
+    char *check = strtok(modifiable, ".");
+    int segments = 0;
+    unsigned char ipAddress[4] = {0};
+    while (check != NULL) {
+        if (segments > 3) {
+            printf("Could not initialise win32tcp - invalid ip address\n");
+            return 1;
+        }
+        int segmentValue = atoi(check);
+        if (segmentValue > 255 || segmentValue < 0) {
+            printf("Could not initialise win32tcp - invalid ip address\n");
+            return 1;
+        }
+        ipAddress[segments] = segmentValue;
+        check = strtok(NULL, ".");
+        segments++;
+    }
+    if (segments != 4) {
+        printf("Could not initialise win32tcp - invalid ip address\n");
+        return 1;
+    }
+    win32Socket.epollfd = epoll_create1(EPOLL_CLOEXEC);
+    if (win32Socket.epollfd == -1) {
+        return 1;
+    }
+
+    /* hints */
+    struct addrinfo hints;
+    struct addrinfo *result;
+    struct addrinfo *ptr;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET; // IPv4
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_protocol = IPPROTO_TCP;
+
+    /* Resolve the server address and port */
+    int status = getaddrinfo(address, port, &hints, &result);
+    if (status != 0) {
+        return 1;
+    }
+
+    /* Attempt to connect to an address until one succeeds */
+    SOCKET testSocket = INVALID_SOCKET;
+    for (ptr = result; ptr != NULL; ptr = ptr -> ai_next) {
+        testSocket = socket(ptr -> ai_family, ptr -> ai_socktype, ptr -> ai_protocol);
+        if (testSocket == INVALID_SOCKET) {
+            continue;
+        }
+        if (connect(testSocket, ptr -> ai_addr, ptr -> ai_addrlen) == SOCKET_ERROR) {
+            close(testSocket);
+            testSocket = INVALID_SOCKET;
+            continue;
+        }
+        break;
+    }
+    freeaddrinfo(result);
+    if (testSocket == INVALID_SOCKET) {
+        return 1;
+    }
+
+    /* shutdown the connection since no more data will be sent */
+    if (shutdown(testSocket, SD_SEND) == SOCKET_ERROR) {
+        close(testSocket);
+        return 1;
+    }
+
+    /* Receive until the peer closes the connection */
+    char recvbuf[512];
+    do {
+        status = recv(testSocket, recvbuf, sizeof(recvbuf), 0);
+    } while (status > 0);
+
+    /* cleanup */
+    close(testSocket);
+    printf("Successfully connected to %d.%d.%d.%d\n", ipAddress[0], ipAddress[1], ipAddress[2], ipAddress[3]);
+    return 0;
+}
+
+SOCKET *win32tcpCreateSocket() {
+    /* define socket index */
+    int socketIndex = WIN32TCP_NUM_SOCKETS;
+    for (int i = 0; i < WIN32TCP_NUM_SOCKETS; i++) {
+        if (win32Socket.socketOpen[i] == 0) {
+            win32Socket.socketOpen[i] = 1;
+            socketIndex = i;
+            break;
+        }
+    }
+    if (socketIndex == WIN32TCP_NUM_SOCKETS) {
+        /* no sockets left */
+        return NULL;
+    }
+    /* hints */
+    struct addrinfo hints;
+    struct addrinfo *result;
+    struct addrinfo *ptr;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET; // IPv4
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_protocol = IPPROTO_TCP;
+
+    /* Resolve the server address and port */
+    int status = getaddrinfo(win32Socket.address, win32Socket.port, &hints, &result);
+    if (status != 0) {
+        win32Socket.socketOpen[socketIndex] = 0;
+        return NULL;
+    }
+
+    /* Attempt to connect to an address until one succeeds */
+    win32Socket.connectSocket[socketIndex] = INVALID_SOCKET;
+    for (ptr = result; ptr != NULL; ptr = ptr -> ai_next) {
+        win32Socket.connectSocket[socketIndex] = socket(ptr -> ai_family, ptr -> ai_socktype, ptr -> ai_protocol);
+        if (win32Socket.connectSocket[socketIndex] == INVALID_SOCKET) {
+            continue;
+        }
+        if (connect(win32Socket.connectSocket[socketIndex], ptr -> ai_addr, ptr -> ai_addrlen) == SOCKET_ERROR) {
+            close(win32Socket.connectSocket[socketIndex]);
+            win32Socket.connectSocket[socketIndex] = INVALID_SOCKET;
+            continue;
+        }
+        break;
+    }
+    freeaddrinfo(result);
+    if (win32Socket.connectSocket[socketIndex] == INVALID_SOCKET) {
+        win32Socket.socketOpen[socketIndex] = 0;
+        return NULL;
+    }
+    /* AMDC packets are small, don't let nagle hold them back */
+    int noDelay = 1;
+    setsockopt(win32Socket.connectSocket[socketIndex], IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+    /* non-blocking from here on, readiness comes from poll/epoll */
+    int flags = fcntl(win32Socket.connectSocket[socketIndex], F_GETFL, 0);
+    fcntl(win32Socket.connectSocket[socketIndex], F_SETFL, flags | O_NONBLOCK);
+    return &win32Socket.connectSocket[socketIndex];
+}
+
+/* wait for a single socket to be readable (POLLIN) or writable (POLLOUT), returns 1 when ready and 0 on timeout or error */
+int win32tcpWait(SOCKET *socket, short events, int timeout) {
+    struct pollfd pfd;
+    pfd.fd = *socket;
+    pfd.events = events;
+    pfd.revents = 0;
+    int status = poll(&pfd, 1, timeout);
+    while (status == -1 && errno == EINTR) {
+        status = poll(&pfd, 1, timeout);
+    }
+    return status > 0;
+}
+
+/* add a socket to the epoll set used by win32tcpPoll */
+int win32tcpWatchSocket(SOCKET *socket) {
+    struct epoll_event event;
+    event.events = EPOLLIN;
+    event.data.ptr = socket;
+    if (epoll_ctl(win32Socket.epollfd, EPOLL_CTL_ADD, *socket, &event) == -1) {
+        return 1;
+    }
+    return 0;
+}
+
+/* remove a socket from the epoll set (must be called before the socket is closed if it was dup'd, harmless otherwise) */
+int win32tcpUnwatchSocket(SOCKET *socket) {
+    if (epoll_ctl(win32Socket.epollfd, EPOLL_CTL_DEL, *socket, NULL) == -1) {
+        return 1;
+    }
+    return 0;
+}
+
+/* wait up to timeout milliseconds for any watched socket to become readable
+writes at most maxSockets pointers to readable sockets into readySockets and returns how many there are (0 on timeout, -1 on error) */
+int win32tcpPoll(SOCKET **readySockets, int maxSockets, int timeout) {
+    struct epoll_event events[WIN32TCP_NUM_SOCKETS];
+    if (maxSockets > WIN32TCP_NUM_SOCKETS) {
+        maxSockets = WIN32TCP_NUM_SOCKETS;
+    }
+    int ready = epoll_wait(win32Socket.epollfd, events, maxSockets, timeout);
+    if (ready == -1) {
+        if (errno == EINTR) {
+            return 0;
+        }
+        return -1;
+    }
+    for (int i = 0; i < ready; i++) {
+        readySockets[i] = events[i].data.ptr;
+    }
+    return ready;
+}
+
+int win32tcpSend(SOCKET *socket, unsigned char *data, int length) {
+    int sent = 0;
+    while (sent < length) {
+        int status = send(*socket, data + sent, length - sent, MSG_NOSIGNAL);
+        if (status == SOCKET_ERROR) {
+            if ((errno == EAGAIN || errno == EWOULDBLOCK) && win32tcpWait(socket, POLLOUT, WIN32TCP_TIMEOUT)) {
+                continue;
+            }
+            if (errno == EINTR) {
+                continue;
+            }
+            closesocket(*socket);
+            return 1;
+        }
+        sent += status;
+    }
+    return 0;
+}
+
+int win32tcpReceive(SOCKET *socket, unsigned char *buffer, int length) {
+    int status = 1;
+    int bytes = 0;
+    while (status > 0) {
+        status = recv(*socket, buffer, length, 0);
+        if (status == SOCKET_ERROR && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            if (win32tcpWait(socket, POLLIN, WIN32TCP_TIMEOUT)) {
+                status = 1;
+                continue;
+            }
+            return bytes;
+        }
+        if (status > 0) {
+            bytes += status;
+        }
+        if (bytes >= length) {
+            return bytes;
+        }
+    }
+    return bytes;
+}
+
+/* single recv, waits (up to WIN32TCP_TIMEOUT) if nothing is buffered so that callers see the same behaviour as a blocking socket
+returns bytes read, 0 if the peer closed the connection, -1 on error or timeout */
+int win32tcpReceive2(SOCKET *socket, unsigned char *buffer, int length) {
+    int status = recv(*socket, buffer, length, 0);
+    if (status == SOCKET_ERROR && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        if (win32tcpWait(socket, POLLIN, WIN32TCP_TIMEOUT)) {
+            status = recv(*socket, buffer, length, 0);
+        }
+    }
+    return status;
+}
+
+/* single recv that never waits, for sockets reported ready by win32tcpPoll
+returns bytes read, 0 if the peer closed the connection, -1 if there was nothing to read */
+int win32tcpReceiveNonBlocking(SOCKET *socket, unsigned char *buffer, int length) {
+    return recv(*socket, buffer, length, 0);
+}
+
+void win32tcpDeinit() {
+    if (win32Socket.epollfd > 0) {
+        close(win32Socket.epollfd);
+    }
+}
+
+#else
+
 #include <winsock2.h>
 #include <ws2tcpip.h>
 #include <windows.h>
@@ -20,6 +324,8 @@ typedef struct {
     char *port;
     SOCKET connectSocket[WIN32TCP_NUM_SOCKETS];
     char socketOpen[WIN32TCP_NUM_SOCKETS];
+    SOCKET *watchedSockets[WIN32TCP_NUM_SOCKETS]; // sockets waited on by win32tcpPoll
+    int numWatched;
 } win32SocketObject;
 
 win32SocketObject win32Socket;
@@ -29,6 +335,7 @@ int win32tcpInit(char *address, char *port) {
         win32Socket.connectSocket[i] = 0;
         win32Socket.socketOpen[i] = 0;
     }
+    win32Socket.numWatched = 0;
     win32Socket.address = address;
     win32Socket.port = port;
     char modifiable[strlen(address) + 1];
@@ -239,8 +546,70 @@ int win32tcpReceive2(SOCKET *socket, unsigned char *buffer, int length) {
     return status;
 }
 
+/* add a socket to the set used by win32tcpPoll */
+int win32tcpWatchSocket(SOCKET *socket) {
+    if (win32Socket.numWatched >= WIN32TCP_NUM_SOCKETS) {
+        return 1;
+    }
+    win32Socket.watchedSockets[win32Socket.numWatched] = socket;
+    win32Socket.numWatched++;
+    return 0;
+}
+
+/* remove a socket from the set used by win32tcpPoll (call before closing it) */
+int win32tcpUnwatchSocket(SOCKET *socket) {
+    for (int i = 0; i < win32Socket.numWatched; i++) {
+        if (win32Socket.watchedSockets[i] == socket) {
+            win32Socket.numWatched--;
+            win32Socket.watchedSockets[i] = win32Socket.watchedSockets[win32Socket.numWatched];
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* wait up to timeout milliseconds for any watched socket to become readable
+writes at most maxSockets pointers to readable sockets into readySockets and returns how many there are (0 on timeout, -1 on error) */
+int win32tcpPoll(SOCKET **readySockets, int maxSockets, int timeout) {
+    int numWatched = win32Socket.numWatched;
+    if (numWatched == 0) {
+        /* select fails on an empty set */
+        Sleep(timeout);
+        return 0;
+    }
+    SOCKET *watched[WIN32TCP_NUM_SOCKETS];
+    fd_set readSet;
+    FD_ZERO(&readSet);
+    for (int i = 0; i < numWatched; i++) {
+        watched[i] = win32Socket.watchedSockets[i];
+        FD_SET(*watched[i], &readSet);
+    }
+    struct timeval tv;
+    tv.tv_sec = timeout / 1000;
+    tv.tv_usec = (timeout % 1000) * 1000;
+    int status = select(0, &readSet, NULL, NULL, &tv);
+    if (status == SOCKET_ERROR) {
+        return -1;
+    }
+    int ready = 0;
+    for (int i = 0; i < numWatched && ready < maxSockets; i++) {
+        if (FD_ISSET(*watched[i], &readSet)) {
+            readySockets[ready] = watched[i];
+            ready++;
+        }
+    }
+    return ready;
+}
+
+/* single recv for sockets reported ready by win32tcpPoll (will not block in that case) */
+int win32tcpReceiveNonBlocking(SOCKET *socket, unsigned char *buffer, int length) {
+    return recv(*socket, buffer, length, 0);
+}
+
 void win32tcpDeinit() {
     WSACleanup();
 }
 
+#endif /* OS_LINUX */
+
 #endif
\ No newline at end of file